@@ -3,6 +3,10 @@
 #include <chrono>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
 
 //
 // Times the execution of a given function
@@ -33,3 +37,65 @@ std::vector<std::string> string_split(std::string string, std::string delimiter)
 
     return output;
 }
+
+//
+// Number of worker threads worth starting for a given number of work items
+//
+inline unsigned worker_count(size_t work_items, unsigned n_threads = std::thread::hardware_concurrency()) {
+    return static_cast<unsigned>(std::clamp<size_t>(work_items, 1, std::max(n_threads, 1u)));
+}
+
+//
+// Runs a function on a number of worker threads, given the worker index
+// > Worker 0 runs on the calling thread
+// > The first exception thrown by a worker is rethrown once every worker is done
+//
+template <typename Func>
+void run_workers(unsigned n_workers, Func func)
+{
+    std::vector<std::exception_ptr> errors(n_workers);
+    auto run_worker = [&](unsigned worker){
+        try { func(worker); }
+        catch (...) { errors[worker] = std::current_exception(); }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned worker = 1; worker < n_workers; ++worker) {
+        threads.emplace_back(run_worker, worker);
+    }
+    run_worker(0);
+    for (auto& thread : threads) { thread.join(); }
+
+    for (const auto& error : errors) {
+        if (error) { std::rethrow_exception(error); }
+    }
+}
+
+//
+// Splits the range [0, size) into contiguous chunks, each one processed by its own thread
+// > func(chunk, begin, end)
+//
+template <typename Func>
+void parallel_chunks(size_t size, unsigned n_chunks, Func func)
+{
+    const size_t chunk_size = (size + n_chunks - 1) / n_chunks;
+    run_workers(n_chunks, [&](unsigned chunk){
+        func(chunk, std::min(size, chunk * chunk_size), std::min(size, (chunk + 1) * chunk_size));
+    });
+}
+
+//
+// Processes every index of the range [0, count) with a pool of worker threads
+// > Workers pull the next index from a shared counter, which balances uneven work items
+// > func(worker, index)
+//
+template <typename Func>
+void parallel_for_each_index(size_t count, unsigned n_workers, Func func)
+{
+    std::atomic<size_t> next_index{0};
+    run_workers(n_workers, [&](unsigned worker){
+        for (size_t index = next_index++; index < count; index = next_index++) {
+            func(worker, index);
+        }
+    });
+}
@@ -1,19 +1,20 @@
-#include <numeric>
-#include <set>
 #include <vector>
 #include <string>
+#include <bit>
+#include <cstdint>
 #include <algorithm>
-#include <iterator>
-#include <cmath>
-#include <unordered_map>
 
 #include "../common/utils.hpp"
 #include "../common/AoCDay.hpp"
 
+// Card numbers are at most two digits, so each side fits in a 128-bit mask
+using NumbersMask = unsigned __int128;
+
 struct Card
 {
-	std::set<int> numbers{};
-	std::set<int> winning_numbers{};
+	NumbersMask numbers{0};
+	NumbersMask winning_numbers{0};
+	int matches{0};
 };
 
 using InputData = std::vector<Card>;
@@ -25,39 +26,55 @@ class Day04 : public AoCDay<InputData>
     long PartTwo(const InputData& data) const override;
 };
 
+//
+// Counts the set bits of a 128-bit mask
+//
+int popcount(NumbersMask mask) {
+    return std::popcount(static_cast<uint64_t>(mask)) + std::popcount(static_cast<uint64_t>(mask >> 64));
+}
+
+//
+// Reads the space separated numbers in [begin, end) into a bitmask
+//
+NumbersMask parse_numbers_mask(const char* begin, const char* end) {
+    NumbersMask mask{0};
+
+    int value{0};
+    bool reading{false};
+    for (const char* c = begin; c != end; ++c) {
+        if (*c >= '0' && *c <= '9') {
+            value = value * 10 + (*c - '0');
+            reading = true;
+        }
+        else if (reading) {
+            mask |= NumbersMask{1} << value;
+            value = 0;
+            reading = false;
+        }
+    }
+    if (reading) { mask |= NumbersMask{1} << value; }
+
+    return mask;
+}
+
 InputData Day04::ParseInputs(std::ifstream& data) {
     // Actual outputs
     std::vector<Card> cards{};
 
     std::string line;
     while(std::getline(data, line)) {
-        // [0] -> Card number
-        // [1] -> Scratches info
-        const auto card_info = string_split(line, ": ");
+        // Card layout: "Card N: <numbers> | <winning numbers>"
+        const auto colon = line.find(':');
+        const auto bar = line.find('|', colon);
 
-        // [0] -> Numbers
-        // [1] -> Winning Numbers
-        const auto scratches = string_split(card_info[1], " | ");
-
-        // Calculate how many numbers and winning numbers the card involves
-        const auto n_numbers = (scratches[0].size() + 1) / 3;
-        const auto n_winning_numbers = (scratches[1].size() + 1) / 3;
+        const char* text = line.data();
 
         Card card{};
+        card.numbers = parse_numbers_mask(text + colon + 1, text + bar);
+        card.winning_numbers = parse_numbers_mask(text + bar + 1, text + line.size());
 
-        for (int i{0}; i < n_numbers; ++i)
-        {
-            std::string num = scratches[0].substr(0 + i*3, 2);
-            std::replace(num.begin(), num.end(), ' ', '0');
-            card.numbers.insert(std::stoi(num));
-        }
-
-        for (int i{0}; i < n_winning_numbers; ++i)
-        {
-            std::string num = scratches[1].substr(0 + i*3, 2);
-            std::replace(num.begin(), num.end(), ' ', '0');
-            card.winning_numbers.insert(std::stoi(num));
-        }
+        // Matches are shared by both parts, so they are computed once here
+        card.matches = popcount(card.numbers & card.winning_numbers);
 
         cards.push_back(card);
     }
@@ -68,48 +85,35 @@ InputData Day04::ParseInputs(std::ifstream& data) {
 long Day04::PartOne(const InputData& data) const {
     long result{0};
 
+    // 2^(matches-1), or 0 when there are no matches
     for (const auto& card : data) {
-        std::vector<int> common_numbers;
-
-        std::set_intersection(
-            card.numbers.cbegin(), card.numbers.cend(),
-            card.winning_numbers.cbegin(), card.winning_numbers.cend(),
-            std::back_inserter(common_numbers)
-        );
-
-        if (!common_numbers.empty()) {
-            result += std::pow(2, common_numbers.size() - 1);
-        }
+        result += (1L << card.matches) >> 1;
     }
 
 	return result;
 }
 
 long Day04::PartTwo(const InputData& data) const {
-    std::unordered_map<int, int> cards_instances;
+    // Difference array of the copies won by previous cards
+    std::vector<long> copies_delta(data.size() + 1, 0);
 
-    for (int i{0}; i < data.size(); ++i) {
-        const auto& card = data[i];
+    long result{0};
+    long copies{0};
 
-        std::vector<int> common_numbers;
+    for (int i{0}; i < data.size(); ++i) {
+        copies += copies_delta[i];
 
-        std::set_intersection(
-            card.numbers.cbegin(), card.numbers.cend(),
-            card.winning_numbers.cbegin(), card.winning_numbers.cend(),
-            std::back_inserter(common_numbers)
-        );
+        // Original card plus all the won copies
+        const long instances = 1 + copies;
+        result += instances;
 
-        ++cards_instances[i]; // Increase the number of card instances of the current card
-        for (int j{1}; j <= common_numbers.size() && i + j < data.size(); ++j) {
-            cards_instances[i + j] += cards_instances[i];
-        }
+        // Each instance wins one copy of the next 'matches' cards
+        const auto last = std::min<size_t>(i + 1 + data[i].matches, data.size());
+        copies_delta[i + 1] += instances;
+        copies_delta[last] -= instances;
     }
 
-	return std::accumulate(cards_instances.cbegin(), cards_instances.cend(), 0,
-        [](int result, const auto& card_result){
-            return result + card_result.second;
-        }
-    );
+	return result;
 }
 
 int main(int argc, char* argv[]) {
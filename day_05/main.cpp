@@ -3,8 +3,10 @@
 #include <vector>
 #include <array>
 #include <tuple>
-#include <set>
 #include <algorithm>
+#include <thread>
+#include <random>
+#include <cstdio>
 
 #include "../common/utils.hpp"
 #include "../common/AoCDay.hpp"
@@ -19,26 +21,155 @@ struct MapRegion {
 	Range dst{};
 };
 
-using Map = std::set<MapRegion>;
-using Maps = std::array<Map, 7>;
+// Sorted piecewise-linear function stored as flat arrays
+// > Piece 'i' covers the sources [starts[i], starts[i+1]) and the last piece extends to infinity
+// > Every source inside a piece is converted by adding offsets[i]
+struct PiecewiseMap {
+	std::vector<long> starts{};
+	std::vector<long> offsets{};
+};
+
 using Seeds = std::vector<long>;
-using InputData = std::tuple<Seeds, Maps>;
+using InputData = std::tuple<Seeds, PiecewiseMap>;
 
 class Day05 : public AoCDay<InputData>
 {
     InputData ParseInputs(std::ifstream& data) override;
     long PartOne(const InputData& data) const override;
     long PartTwo(const InputData& data) const override;
+
+public:
+    void RunScaling(int argc, char* argv[]);
 };
 
-bool operator < (const MapRegion& lhs, const MapRegion& rhs) {
-	return (lhs.src.min < rhs.src.min);
+constexpr long INFINITE_SOURCE = std::numeric_limits<long>::max();
+
+//
+// Appends a piece to the map, merging it with the previous one when both share the same offset
+//
+void push_piece(PiecewiseMap& map, long start, long offset) {
+	if (!map.offsets.empty() && map.offsets.back() == offset) { return; }
+	map.starts.push_back(start);
+	map.offsets.push_back(offset);
+}
+
+//
+// Index of the piece containing the given source value
+//
+size_t find_piece(const PiecewiseMap& map, long value) {
+	const auto it = std::upper_bound(map.starts.cbegin(), map.starts.cend(), value);
+	return it == map.starts.cbegin() ? 0 : std::distance(map.starts.cbegin(), it) - 1;
+}
+
+//
+// Exclusive end of a given piece
+//
+long piece_end(const PiecewiseMap& map, size_t piece) {
+	return piece + 1 < map.starts.size() ? map.starts[piece + 1] : INFINITE_SOURCE;
+}
+
+//
+// Converts the regions of an almanac map into a piecewise map covering every source from 0
+// > Gaps between regions keep their values unchanged (offset 0)
+//
+PiecewiseMap build_piecewise_map(std::vector<MapRegion> regions) {
+	std::sort(regions.begin(), regions.end(), [](const MapRegion& lhs, const MapRegion& rhs){
+		return lhs.src.min < rhs.src.min;
+	});
+
+	PiecewiseMap map{};
+
+	long cursor{0};
+	for (const auto& region : regions) {
+		if (region.src.min > cursor) { push_piece(map, cursor, 0); }
+		push_piece(map, region.src.min, region.dst.min - region.src.min);
+		cursor = region.src.max + 1;
+	}
+	push_piece(map, cursor, 0);
+
+	return map;
+}
+
+//
+// Composes two piecewise maps into a single one, equivalent to applying 'first' and then 'second'
+// > Each piece of 'first' is split at the breakpoints of 'second' that fall inside its image
+//
+PiecewiseMap compose_maps(const PiecewiseMap& first, const PiecewiseMap& second) {
+	PiecewiseMap composed{};
+
+	for (size_t i{0}; i < first.starts.size(); ++i) {
+		const long offset = first.offsets[i];
+		const long end = piece_end(first, i);
+
+		// Image of the current piece
+		const long image_min = first.starts[i] + offset;
+		const long image_end = end == INFINITE_SOURCE ? INFINITE_SOURCE : end + offset;
+
+		for (size_t j = find_piece(second, image_min); ; ++j) {
+			const long image_start = std::max(image_min, second.starts[j]);
+			push_piece(composed, image_start - offset, offset + second.offsets[j]);
+
+			if (piece_end(second, j) >= image_end) { break; }
+		}
+	}
+
+	return composed;
+}
+
+//
+// Minimum converted value of all the values inside a given range
+// > Pieces are increasing, so only the first value of each overlapping piece is a candidate
+//
+long map_range_min(const PiecewiseMap& map, const Range& range) {
+	size_t piece = find_piece(map, range.min);
+	long result = range.min + map.offsets[piece];
+
+	for (++piece; piece < map.starts.size() && map.starts[piece] <= range.max; ++piece) {
+		result = std::min(result, map.starts[piece] + map.offsets[piece]);
+	}
+
+	return result;
+}
+
+//
+// Minimum converted value of a sorted batch of values
+// > Single merge pass: the piece cursor only moves forward while walking the batch
+//
+long map_sorted_min(const PiecewiseMap& map, const long* begin, const long* end) {
+	long result = std::numeric_limits<long>::max();
+
+	size_t piece = begin == end ? 0 : find_piece(map, *begin);
+	for (const long* value = begin; value != end; ++value) {
+		while (piece + 1 < map.starts.size() && map.starts[piece + 1] <= *value) { ++piece; }
+		result = std::min(result, *value + map.offsets[piece]);
+	}
+
+	return result;
+}
+
+//
+// Minimum converted value of a batch of values, evaluated in parallel
+// > The batch is split into chunks, each one sorted and merged against the map by its own thread
+// > The per-chunk minimums are reduced at the end
+//
+long map_batch_min(const PiecewiseMap& map, Seeds values, unsigned n_threads = std::thread::hardware_concurrency()) {
+	// Small batches are not worth the threads overhead
+	constexpr size_t MIN_CHUNK_SIZE = 1 << 16;
+	const unsigned n_chunks = worker_count(values.size() / MIN_CHUNK_SIZE, n_threads);
+
+	std::vector<long> chunk_results(n_chunks, std::numeric_limits<long>::max());
+	parallel_chunks(values.size(), n_chunks, [&](unsigned chunk, size_t begin, size_t end){
+		std::sort(values.begin() + begin, values.begin() + end);
+		chunk_results[chunk] = map_sorted_min(map, values.data() + begin, values.data() + end);
+	});
+
+	return *std::min_element(chunk_results.cbegin(), chunk_results.cend());
 }
 
 InputData Day05::ParseInputs(std::ifstream& data) {
     // Actual outputs
     Seeds seeds{};
-	Maps maps{};
+	PiecewiseMap almanac{};
 
     std::string line;
 
@@ -57,7 +188,7 @@ InputData Day05::ParseInputs(std::ifstream& data) {
 
 	// Read the maps
 	for (int i{0}; i < 7; ++i) {
-		Map current_map{};
+		std::vector<MapRegion> regions{};
 
 		// Map name
 		std::getline(data, line);
@@ -76,125 +207,63 @@ InputData Day05::ParseInputs(std::ifstream& data) {
 				Range{src_min, src_min + range - 1},
 				Range{dst_min, dst_min + range - 1}
 			};
-			current_map.insert(region);
+			regions.push_back(region);
 		}
 
-		// Adds the created map into the list
-		maps[i] = current_map;
+		// Composes the created map with the previous ones
+		const auto map = build_piecewise_map(regions);
+		almanac = i == 0 ? map : compose_maps(almanac, map);
 	}
 
-    return {seeds, maps};
+    return {seeds, almanac};
 }
 
 long Day05::PartOne(const InputData& data) const {
-	const auto& [seeds, maps] = data;
-
-	Seeds locations = seeds;
-
-	for (auto& seed : locations) {
-		for (const auto& map : maps) {
-			for (const auto& region : map) {
-				// Upcoming regions will not contain the seed
-				if (seed < region.src.min) { break; }
-
-				// Pass to the next region
-				if (seed > region.src.max) { continue; }
-
-				// Convert seed value
-				// > Pass to next seed
-				seed += region.dst.min - region.src.min;
-				break;
-			}
-		}
-	}
-
-	return *std::min_element(locations.cbegin(), locations.cend());
+	const auto& [seeds, almanac] = data;
+	return map_batch_min(almanac, seeds);
 }
 
 long Day05::PartTwo(const InputData& data) const {
-	const auto& [seeds, maps] = data;
-
-	// Re-Arrange seeds to fulfill new conditions
-	std::vector<Range> locations;
-	for (int i{0}; i < seeds.size(); i+=2) {
-		locations.push_back(Range{
-			seeds[i], seeds[i] + seeds[i+1] - 1
-		});
+	const auto& [seeds, almanac] = data;
+
+	long result = std::numeric_limits<long>::max();
+	for (int i{0}; i + 1 < seeds.size(); i+=2) {
+		const Range range{ seeds[i], seeds[i] + seeds[i+1] - 1 };
+		result = std::min(result, map_range_min(almanac, range));
 	}
 
-	for (const auto& map : maps) {
-		// Vector that will gather the generated locations for next map
-		std::vector<Range> next_locations;
-
-		for (auto& location : locations) {
-			for (auto region = map.cbegin(); region != map.cend(); region++) {
-				// Location range ahead map region
-				// > Go to next region
-				// > If last region, save location for next map
-				if (location.min > region->src.max) {
-					if (std::next(region) == map.cend()) {
-						next_locations.push_back(location);
-					}
-					continue;
-				}
-
-				// Location range behind map region
-				// > No intersection will occurr with the upcoming regions
-				// > Location remains unchanged for next map
-				if (location.max < region->src.min) {
-					next_locations.push_back(location);
-					break;
-				}
-
-				// If reached here, the location is intersecting with map region
-				const Range intersection {
-					std::max(location.min, region->src.min),
-					std::min(location.max, region->src.max)
-				};
-
-				// Check if intersection does not contain all the initial location points
-				// > Created region remains unchanged for next map
-				if (intersection.min > location.min) {
-					next_locations.push_back(Range{
-						location.min,
-						intersection.min - 1
-					});
-				}
-
-				// Apply the map convertion to the intersection zone
-				next_locations.push_back(Range{
-					intersection.min - region->src.min + region->dst.min,
-					intersection.max - region->src.min + region->dst.min
-				});
-
-				// Check if intersection does not contain all the final location points
-				// > Updates the current location for next region check
-				// > If last region, save updated location for next map
-				if (intersection.max < location.max) {
-					location.min = intersection.max + 1;
-					if (std::next(region) == map.cend()) {
-						next_locations.push_back(location);
-					}
-				}
-				// If the intersection does indeed contaill all the final location points
-				// > No need to check the next region
-				else { break; }
-			}
-		}
+	return result;
+}
 
-		// Updates the location for next map
-		locations = next_locations;
+//
+// Times the parallel batch evaluation on random seeds, for an increasing number of threads
+//
+void Day05::RunScaling(int argc, char* argv[]) {
+	RunParseInputs(argc, argv);
+	const auto& [_, almanac] = INPUT_DATA;
+
+	constexpr size_t N_SEEDS = 30000000;
+	std::mt19937_64 generator{2023};
+	std::uniform_int_distribution<long> distribution{0, 4000000000L};
+	Seeds seeds(N_SEEDS);
+	for (auto& seed : seeds) { seed = distribution(generator); }
+
+	printf("\n> Scaling < (%zu random seeds, %u hardware threads)\n", N_SEEDS, std::thread::hardware_concurrency());
+
+	for (const unsigned n_threads : {1u, 2u, 4u, 8u, 16u}) {
+		long result{0};
+		const float elapsed_time = time_block([&](){ result = map_batch_min(almanac, seeds, n_threads); });
+		printf("   %2u threads: %f seconds (result %ld)\n", n_threads, elapsed_time, result);
 	}
-
-	return (*std::min_element(
-		locations.cbegin(), locations.cend(),
-		[](const Range& lhs, const Range& rhs){
-			return lhs.min < rhs.min;
-		}
-	)).min;
 }
 
 int main(int argc, char* argv[]) {
+	// Measures the batch evaluation scaling instead of solving the input
+	if (argc > 2 && std::string(argv[2]) == "--scaling") {
+		Day05{}.RunScaling(argc, argv);
+		return 0;
+	}
+
 	Day05{}.Run(argc, argv);
 	return 0;
 }
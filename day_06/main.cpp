@@ -4,6 +4,9 @@
 #include <cmath>
 #include <algorithm>
 #include <numeric>
+#include <functional>
+#include <random>
+#include <cstdio>
 
 #include "../common/utils.hpp"
 #include "../common/AoCDay.hpp"
@@ -34,22 +37,135 @@ class Day06 : public AoCDay<InputData>
 //       (time threshold initial) = ( (time total) - sqrt( (time total)^2 - 4*record ) ) / 2
 //       (time threshold final)   = ( (time total) + sqrt( (time total)^2 - 4*record ) ) / 2
 // > We only care about (time threshold initial) since this is mirrored distribution
+// > Everything is computed with exact 128-bit integers, since (time total)^2 quickly exceeds
+//   the exact range of a double
+using Int128 = __int128;
+
+//
+// Exact integer square root (largest 'x' such that x*x <= value)
+//
+Int128 isqrt(Int128 value) {
+	if (value < 2) { return value; }
+
+	// Floating point estimation, followed by an exact correction
+	Int128 root = static_cast<Int128>(std::sqrt(static_cast<long double>(value)));
+	while (root * root > value) { --root; }
+	while ((root + 1) * (root + 1) <= value) { ++root; }
+
+	return root;
+}
+
 long beatable_records(const Record& record) {
-	// Values that will be used in the equation
-	const long time_power = std::pow(record.time, 2);
-	const long value_for_sqrt = time_power - 4 * record.distance;
+	const Int128 time = record.time;
+	const Int128 distance = record.distance;
+
+	// Checks if the given hold time breaks the record
+	auto beats = [&](Int128 hold){ return (time - hold) * hold > distance; };
+
+	// If the discriminant is not positive => record impossible to break
+	const Int128 discriminant = time * time - 4 * distance;
+	if (discriminant <= 0) { return 0; }
+
+	// Time threshold, adjusted to the first hold time that actually breaks the record
+	Int128 time_th = (time - isqrt(discriminant)) / 2;
+	while (time_th > 0 && beats(time_th - 1)) { --time_th; }
+	while (time_th <= time / 2 && !beats(time_th)) { ++time_th; }
+
+	// Not even the best hold time (half of the total time) breaks the record
+	if (time_th > time / 2) { return 0; }
+
+	return static_cast<long>(time + 1 - time_th * 2);
+}
+
+//
+// Computes the number of ways to beat each record of a batch
+// > First pass: floating point estimation of every time threshold, branch-free so it vectorizes
+//   (square roots only vectorize without errno, hence -fno-math-errno in this day's build)
+// > Second pass: exact check of each estimation, falling back to the exact solver when it is off
+//
+std::vector<long> beatable_records(const Records& records) {
+	const std::size_t n_records = records.size();
+
+	std::vector<double> times(n_records), distances(n_records);
+	for (std::size_t i{0}; i < n_records; ++i) {
+		times[i] = records[i].time;
+		distances[i] = records[i].distance;
+	}
+
+	// Negative discriminants give NaN, which the second pass rejects
+	std::vector<double> estimations(n_records);
+	for (std::size_t i{0}; i < n_records; ++i) {
+		estimations[i] = (times[i] - std::sqrt(times[i] * times[i] - 4.0 * distances[i])) * 0.5;
+	}
+
+	std::vector<long> results(n_records);
+	for (std::size_t i{0}; i < n_records; ++i) {
+		const Int128 time = records[i].time;
+		const Int128 distance = records[i].distance;
+
+		if (!(estimations[i] >= 0.0 && estimations[i] <= times[i])) {
+			results[i] = beatable_records(records[i]);
+			continue;
+		}
+
+		// Estimation is exact if it breaks the record and the hold time before it does not
+		const Int128 time_th = static_cast<long>(estimations[i]) + 1;
+		const bool exact = time_th <= time / 2
+			&& (time - time_th) * time_th > distance
+			&& (time - time_th + 1) * (time_th - 1) <= distance;
+
+		results[i] = exact ? static_cast<long>(time + 1 - time_th * 2) : beatable_records(records[i]);
+	}
 
-	// If the value for the sqrt is negative => record impossible to break
-	if (value_for_sqrt <= 0) { return 0; }
+	return results;
+}
 
-	// Time threshold
-	long time_th = std::ceil((record.time - std::sqrt(value_for_sqrt) ) / 2.0);
+//
+// Number of ways to beat a record, by trying every hold time
+//
+long brute_force_beatable_records(const Record& record) {
+	long count{0};
+	for (long hold{0}; hold <= record.time; ++hold) {
+		count += (record.time - hold) * hold > record.distance;
+	}
+	return count;
+}
 
-	// If the time threshold is exactly the same distance record, increase to next tick
-	long time_th_distance = (record.time - time_th) * time_th;
-	if (time_th_distance == record.distance) { time_th++; }
+//
+// Differential check of both solvers against brute force
+// > Every reachable record of the short races, plus random records of long races close to the best distance
+//
+bool verify_beatable_records() {
+	Records records{};
 
-	return record.time + 1 - time_th * 2;
+	for (long time{0}; time <= 200; ++time) {
+		for (long distance{0}; distance <= time * time / 4 + 1; ++distance) {
+			records.push_back({time, distance});
+		}
+	}
+
+	std::mt19937_64 generator{2023};
+	for (int i{0}; i < 1000; ++i) {
+		const long time = std::uniform_int_distribution<long>{1, 2000000}(generator);
+		const long best = (time / 2) * (time - time / 2);
+		const long distance = best - std::uniform_int_distribution<long>{-2, std::min(best, 1000000L)}(generator);
+		records.push_back({time, distance});
+	}
+
+	const auto results = beatable_records(records);
+
+	long mismatches{0};
+	for (std::size_t i{0}; i < records.size(); ++i) {
+		const long expected = brute_force_beatable_records(records[i]);
+		if (beatable_records(records[i]) != expected || results[i] != expected) {
+			printf("   Mismatch for time %ld and distance %ld\n", records[i].time, records[i].distance);
+			++mismatches;
+		}
+	}
+
+	printf("\n> Verify < (%zu records, %ld mismatches)\n", records.size(), mismatches);
+
+	return mismatches == 0;
 }
 
 InputData Day06::ParseInputs(std::ifstream& data) {
@@ -100,10 +216,8 @@ InputData Day06::ParseInputs(std::ifstream& data) {
 
 long Day06::PartOne(const InputData& data) const {
 	const auto& [records, _] = data;
-	return std::accumulate(
-		records.cbegin(), records.cend(), 1,
-		[](long result, const Record& record){ return result * beatable_records(record); }
-	);
+	const auto results = beatable_records(records);
+	return std::accumulate(results.cbegin(), results.cend(), 1L, std::multiplies<long>());
 }
 
 long Day06::PartTwo(const InputData& data) const {
@@ -112,6 +226,11 @@ long Day06::PartTwo(const InputData& data) const {
 }
 
 int main(int argc, char* argv[]) {
+	// Checks the solvers against brute force instead of solving an input
+	if (argc > 1 && std::string(argv[1]) == "--verify") {
+		return verify_beatable_records() ? 0 : 1;
+	}
+
 	Day06{}.Run(argc, argv);
 	return 0;
 }
@@ -1,10 +1,12 @@
 #include <numeric>
-#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
-#include <unordered_map>
+#include <array>
+#include <cstdint>
 #include <algorithm>
+#include <random>
+#include <cstdio>
 
 #include "../common/utils.hpp"
 #include "../common/AoCDay.hpp"
@@ -24,13 +26,14 @@ struct Hand {
 	int bid{0};
 };
 
-struct HandAux {
-	HandStrength weight{};
-	std::string cards_remap{};
-	std::string cards_joker_best{};
-};
+// Hand packed as a single integer key
+// > Bits [20, 23) -> Hand strength
+// > Bits [0, 20)  -> Rank of each card (4 bits each), first card in the most significant nibble
+using HandKey = uint32_t;
+
+// Hand key in the upper 32 bits and bid in the lower 32 bits, sortable as a single integer
+using RankedHand = uint64_t;
 
-using HandInfo = std::pair<Hand, HandAux>;
 using InputData = std::vector<Hand>;
 
 class Day07 : public AoCDay<InputData>
@@ -40,76 +43,233 @@ class Day07 : public AoCDay<InputData>
     long PartTwo(const InputData& data) const override;
 };
 
-bool operator < (const HandInfo& lhs, const HandInfo& rhs) {
-	return (lhs.second.weight < rhs.second.weight) || ((lhs.second.weight == rhs.second.weight) && (lhs.second.cards_remap < rhs.second.cards_remap));
+// Card labels sorted by rank
+constexpr std::string_view CARDS_ORDER{"23456789TJQKA"};
+constexpr std::string_view CARDS_ORDER_JOKER{"J23456789TQKA"};
+
+//
+// Classifies a hand given the number of matching pairs between its non joker cards, and its jokers
+// > Pairs identify the highest and second highest repetitions of the non joker cards:
+//    0 -> (1, 1) | 1 -> (2, 1) | 2 -> (2, 2) | 3 -> (3, 1) | 4 -> (3, 2) | 6 -> (4, 1) | 10 -> (5, 0)
+// > Jokers join the most repeated card
+//
+constexpr HandStrength classify_hand(int pairs, int jokers) {
+	int first = pairs == 10 ? 5 : pairs == 6 ? 4 : pairs >= 3 ? 3 : pairs >= 1 ? 2 : 1;
+	const int second = (pairs == 2 || pairs == 4) ? 2 : 1;
+
+	if (jokers == 5) { first = 0; }
+	first += jokers;
+
+	if (first == 5) { return HandStrength::FiveKind; }
+	if (first == 4) { return HandStrength::FourKind; }
+	if (first == 3) { return second == 2 ? HandStrength::FullHouse : HandStrength::Triple; }
+	if (first == 2) { return second == 2 ? HandStrength::DoublePair : HandStrength::OnePair; }
+	return HandStrength::HightHand;
 }
 
-std::string remap_cards(std::string cards, const std::unordered_map<char, char>& map) {
-	std::transform(cards.begin(), cards.end(), cards.begin(), [&map](char card){ return map.at(card); });
-	return cards;
-}
+// Number of possible hands (5 cards out of 13 labels, base-13 encoded)
+constexpr int N_HANDS = 13 * 13 * 13 * 13 * 13;
 
-std::string best_scenario_cards(std::string cards, const std::unordered_map<char, char>& map) {
-	std::map<char, int> cards_counter{{'1', 0}};
+// Plain arrays are used instead of std::array, since they are much cheaper to evaluate at compile time
+struct HandStrengthTable {
+	uint8_t strengths[N_HANDS]{};
+};
 
-	for (const char& card : cards) {
-		++cards_counter[card];
+//
+// Classifies every possible hand, indexed by its base-13 encoding
+// > Pairs and jokers are accumulated loop by loop, which keeps the compile time evaluation cheap
+// > Nested loops also keep every single loop within the compiler constexpr loop limits
+//
+constexpr HandStrengthTable make_hand_strength_table(bool joker) {
+	HandStrengthTable table{};
+
+	// Every possible classification, given the number of pairs and jokers
+	uint8_t classifications[11][6]{};
+	for (int pairs{0}; pairs < 11; ++pairs) {
+		for (int jokers{0}; jokers < 6; ++jokers) {
+			classifications[pairs][jokers] = static_cast<uint8_t>(classify_hand(pairs, jokers));
+		}
 	}
 
-	// No J's
-	if (cards_counter['1'] == 0) { return cards; }
+	// Repetitions of each non joker rank among the cards of the outer loops
+	// > Jokers (rank 0 in the joker order) never count as a matching pair
+	int counter[13]{};
+	const int first_rank = joker ? 1 : 0;
+
+	int index{0};
+	for (int r0{0}; r0 < 13; ++r0) {
+		const int j0 = r0 < first_rank;
+		counter[r0] += 1 - j0;
+		for (int r1{0}; r1 < 13; ++r1) {
+			const int p1 = counter[r1] * (r1 >= first_rank);
+			const int j1 = j0 + (r1 < first_rank);
+			counter[r1] += r1 >= first_rank;
+			for (int r2{0}; r2 < 13; ++r2) {
+				const int p2 = p1 + counter[r2] * (r2 >= first_rank);
+				const int j2 = j1 + (r2 < first_rank);
+				counter[r2] += r2 >= first_rank;
+				for (int r3{0}; r3 < 13; ++r3) {
+					const int p3 = p2 + counter[r3] * (r3 >= first_rank);
+					const int j3 = j2 + (r3 < first_rank);
+					counter[r3] += r3 >= first_rank;
+					// Last card is a joker (only in the joker order)
+					for (int r4{0}; r4 < first_rank; ++r4) {
+						table.strengths[index++] = classifications[p3][j3 + 1];
+					}
+					for (int r4{first_rank}; r4 < 13; ++r4) {
+						table.strengths[index++] = classifications[p3 + counter[r4]][j3];
+					}
+					counter[r3] -= r3 >= first_rank;
+				}
+				counter[r2] -= r2 >= first_rank;
+			}
+			counter[r1] -= r1 >= first_rank;
+		}
+		counter[r0] -= 1 - j0;
+	}
 
-	// All J's
-	if (cards_counter['1'] == 5) { return remap_cards("AAAAA", map); }
+	return table;
+}
 
-	std::pair<char, int> best_candidate{'2', 0};
-	for (auto counter = cards_counter.cbegin(); counter != cards_counter.cend(); ++counter) {
-		if (counter->first == '1') { continue; }
-		if (counter->second >= best_candidate.second) {
-			best_candidate = *counter;
-		}
+// Classification tables, generated at compile time
+constexpr HandStrengthTable HAND_STRENGTHS = make_hand_strength_table(false);
+constexpr HandStrengthTable HAND_STRENGTHS_JOKER = make_hand_strength_table(true);
+
+static_assert(HAND_STRENGTHS.strengths[0] == static_cast<uint8_t>(HandStrength::FiveKind));
+static_assert(HAND_STRENGTHS.strengths[1] == static_cast<uint8_t>(HandStrength::FourKind));
+static_assert(HAND_STRENGTHS_JOKER.strengths[1] == static_cast<uint8_t>(HandStrength::FiveKind));
+static_assert(HAND_STRENGTHS_JOKER.strengths[N_HANDS - 1] == static_cast<uint8_t>(HandStrength::FiveKind));
+
+//
+// Classifies a hand by counting its cards, which is the reference for the lookup tables
+//
+HandStrength count_hand_strength(const std::array<int, 5>& ranks, bool joker) {
+	std::array<int, 13> cards_counter{};
+	for (const auto& rank : ranks) {
+		++cards_counter[rank];
 	}
 
-	std::transform(
-		cards.begin(), cards.end(),
-		cards.begin(),
-		[&best_candidate](char card){ return card == '1' ? best_candidate.first : card; }
-	);
+	// Jokers join the most repeated card
+	int jokers{0};
+	if (joker) { std::swap(jokers, cards_counter[0]); }
 
-	return cards;
+	// Two highest card counts
+	int first{0}, second{0};
+	for (const auto& count : cards_counter) {
+		if (count > first) { second = first; first = count; }
+		else if (count > second) { second = count; }
+	}
+	first += jokers;
+
+	if (first == 5) { return HandStrength::FiveKind; }
+	if (first == 4) { return HandStrength::FourKind; }
+	if (first == 3) { return second == 2 ? HandStrength::FullHouse : HandStrength::Triple; }
+	if (first == 2) { return second == 2 ? HandStrength::DoublePair : HandStrength::OnePair; }
+	return HandStrength::HightHand;
 }
 
-HandStrength find_hand_strength(const std::string& cards) {
-	std::unordered_map<char, int> cards_counter{};
-	for (const auto& card : cards) {
-		++cards_counter[card];
-	}
+HandKey encode_hand_by_counts(const std::string& cards, bool joker) {
+	const auto& order = joker ? CARDS_ORDER_JOKER : CARDS_ORDER;
 
-	if (cards_counter.size() == 1) {
-		return HandStrength::FiveKind;
+	std::array<int, 5> ranks{};
+	HandKey key{0};
+	for (int i{0}; i < 5; ++i) {
+		ranks[i] = order.find(cards[i]);
+		key = (key << 4) | ranks[i];
 	}
 
-	if (cards_counter.size() == 4) {
-		return HandStrength::OnePair;
+	return key | (static_cast<HandKey>(count_hand_strength(ranks, joker)) << 20);
+}
+
+HandKey encode_hand(const std::string& cards, bool joker) {
+	const auto& order = joker ? CARDS_ORDER_JOKER : CARDS_ORDER;
+	const auto& strengths = joker ? HAND_STRENGTHS_JOKER : HAND_STRENGTHS;
+
+	HandKey key{0};
+	int index{0};
+	for (int i{0}; i < 5; ++i) {
+		const int rank = order.find(cards[i]);
+		key = (key << 4) | rank;
+		index = index * 13 + rank;
 	}
 
-	if (cards_counter.size() == 2) {
-		if (cards_counter.begin()->second == 4 || cards_counter.begin()->second == 1) {
-			return HandStrength::FourKind;
+	return key | (static_cast<HandKey>(strengths.strengths[index]) << 20);
+}
+
+//
+// LSD radix sort over the hand keys (upper 32 bits) of the ranked hands
+// > Keys only use 23 bits, so three 8-bit passes are enough
+//
+void radix_sort_hands(std::vector<RankedHand>& hands) {
+	std::vector<RankedHand> buffer(hands.size());
+
+	for (int shift{32}; shift < 56; shift += 8) {
+		std::array<size_t, 257> offsets{};
+		for (const auto& hand : hands) {
+			++offsets[((hand >> shift) & 0xFF) + 1];
 		}
-		return HandStrength::FullHouse;
-	}
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
 
-	for (const auto& count : cards_counter) {
-		if (count.second == 2) {
-			return HandStrength::DoublePair;
+		for (const auto& hand : hands) {
+			buffer[offsets[(hand >> shift) & 0xFF]++] = hand;
 		}
-		if (count.second == 3) {
-			return HandStrength::Triple;
+		hands.swap(buffer);
+	}
+}
+
+//
+// Total winnings of all the hands, given their ranking
+//
+long total_winnings(const InputData& data, bool joker) {
+	std::vector<RankedHand> hands(data.size());
+	std::transform(data.cbegin(), data.cend(), hands.begin(), [joker](const Hand& hand){
+		return (static_cast<RankedHand>(encode_hand(hand.cards, joker)) << 32) | static_cast<uint32_t>(hand.bid);
+	});
+
+	radix_sort_hands(hands);
+
+	long result{0};
+	for (size_t i{0}; i < hands.size(); ++i) {
+		result += static_cast<long>(hands[i] & 0xFFFFFFFF) * (i + 1);
+	}
+
+	return result;
+}
+
+//
+// Compares the lookup tables against the count-based classification
+// > Checks that both agree on every possible hand, then times both on random hands
+//
+bool benchmark_hand_classification() {
+	long mismatches{0};
+	for (const bool joker : {false, true}) {
+		const auto& order = joker ? CARDS_ORDER_JOKER : CARDS_ORDER;
+		std::string cards(5, ' ');
+		for (int index{0}; index < N_HANDS; ++index) {
+			for (int i{4}, rest{index}; i >= 0; --i, rest /= 13) { cards[i] = order[rest % 13]; }
+			mismatches += encode_hand(cards, joker) != encode_hand_by_counts(cards, joker);
 		}
 	}
+	printf("\n> Check < (%d hands, %ld mismatches)\n", 2 * N_HANDS, mismatches);
 
-	return HandStrength::HightHand;
+	constexpr int N_RANDOM_HANDS = 5000000;
+	std::mt19937 generator{2023};
+	std::vector<std::string> hands(N_RANDOM_HANDS, std::string(5, ' '));
+	for (auto& cards : hands) {
+		for (auto& card : cards) { card = CARDS_ORDER[generator() % 13]; }
+	}
+
+	for (const bool table : {false, true}) {
+		HandKey checksum{0};
+		const float elapsed_time = time_block([&](){
+			for (const auto& cards : hands) {
+				checksum ^= table ? encode_hand(cards, true) : encode_hand_by_counts(cards, true);
+			}
+		});
+		printf("\n> %s < (%f seconds, checksum %u)\n", table ? "Lookup tables" : "Card counts", elapsed_time, checksum);
+	}
+
+	return mismatches == 0;
 }
 
 InputData Day07::ParseInputs(std::ifstream& data) {
@@ -130,61 +290,19 @@ InputData Day07::ParseInputs(std::ifstream& data) {
 }
 
 long Day07::PartOne(const InputData& data) const {
-	const std::unordered_map<char, char> card_remap {
-		{'2', '2'}, {'3', '3'}, {'4', '4'},
-		{'5', '5'}, {'6', '6'}, {'7', '7'},
-		{'8', '8'}, {'9', '9'}, {'T', 'A'},
-		{'J', 'B'}, {'Q', 'C'}, {'K', 'D'},
-		{'A', 'E'}
-	};
-
-	std::set<HandInfo> hands_sorted;
-
-	for (auto& hand : data) {
-		const std::string remapped_cards = remap_cards(hand.cards, card_remap);
-		const HandStrength weight = find_hand_strength(hand.cards);
-		const HandAux hand_info{weight, remapped_cards, remapped_cards};
-		hands_sorted.insert(std::make_pair(hand, hand_info));
-	}
-
-	return std::accumulate(
-		hands_sorted.cbegin(), hands_sorted.cend(), 0L,
-		[](long result, const HandInfo& hand_info){
-			static long counter{0};
-			return result + hand_info.first.bid * ++counter;
-		}
-	);
+	return total_winnings(data, false);
 }
 
 long Day07::PartTwo(const InputData& data) const {
-	const std::unordered_map<char, char> card_remap {
-		{'2', '2'}, {'3', '3'}, {'4', '4'},
-		{'5', '5'}, {'6', '6'}, {'7', '7'},
-		{'8', '8'}, {'9', '9'}, {'T', 'A'},
-		{'J', '1'}, {'Q', 'C'}, {'K', 'D'},
-		{'A', 'E'}
-	};
-
-	std::set<HandInfo> hands_sorted;
-
-	for (auto& hand : data) {
-		const std::string remapped_cards = remap_cards(hand.cards, card_remap);
-		const std::string best_cards = best_scenario_cards(remapped_cards, card_remap);
-		const HandStrength weight = find_hand_strength(best_cards);
-		const HandAux hand_info{weight, remapped_cards, best_cards};
-		hands_sorted.insert(std::make_pair(hand, hand_info));
-	}
-
-	return std::accumulate(
-		hands_sorted.cbegin(), hands_sorted.cend(), 0L,
-		[](long result, const HandInfo& hand_info){
-			static long counter{0};
-			return result + hand_info.first.bid * ++counter;
-		}
-	);
+	return total_winnings(data, true);
 }
 
 int main(int argc, char* argv[]) {
+	// Benchmarks the hand classification instead of solving an input
+	if (argc > 1 && std::string(argv[1]) == "--benchmark") {
+		return benchmark_hand_classification() ? 0 : 1;
+	}
+
 	Day07{}.Run(argc, argv);
 	return 0;
 }
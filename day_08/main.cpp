@@ -3,15 +3,34 @@
 #include <string>
 #include <fstream>
 #include <tuple>
-#include <unordered_map>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <algorithm>
+#include <stdexcept>
+#include <thread>
 
 #include "../common/utils.hpp"
 #include "../common/AoCDay.hpp"
 
-using Choice = std::array<std::string, 2>;
-using Map = std::unordered_map<std::string, Choice>;
-using InputData = std::tuple<std::string, Map>;
+using NodeId = uint16_t;
+
+// Network of nodes interned into dense integer ids
+// > Children are stored in two flat arrays, indexed by the node id
+// > Start ('..A') and end ('..Z') predicates are stored as bitsets
+struct Network {
+	std::vector<NodeId> left{};
+	std::vector<NodeId> right{};
+	std::vector<bool> starts{};
+	std::vector<bool> ends{};
+	int first{-1}; // Id of 'AAA', if it exists
+	int last{-1};  // Id of 'ZZZ', if it exists
+};
+
+// Moving pattern, where 0 -> Left and 1 -> Right
+using Pattern = std::vector<uint8_t>;
+using InputData = std::tuple<Pattern, Network>;
 
 class Day08 : public AoCDay<InputData>
 {
@@ -20,89 +39,408 @@ class Day08 : public AoCDay<InputData>
     long PartTwo(const InputData& data) const override;
 };
 
+//
+// Packs a 3 character node name (digits or upper case letters) into a base-36 integer
+//
+int pack_node_name(const std::string& line, size_t index) {
+	int packed{0};
+	for (size_t i{index}; i < index + 3; ++i) {
+		const char c = line[i];
+		packed = packed * 36 + (c <= '9' ? c - '0' : c - 'A' + 10);
+	}
+	return packed;
+}
+
+// Single pass of the full pattern from every node
+// > next[node]      -> Node reached after a full pattern pass
+// > hits[node]      -> A stop node is reached during the pass
+// > first_hit[node] -> Steps to the first stop node within the pass (0 if none)
+struct PatternPass {
+	long period{0};
+	std::vector<NodeId> next{};
+	std::vector<bool> hits{};
+	std::vector<int> first_hit{};
+};
+
+// Binary lifting table over full pattern passes, built on top of a single pass
+// > passes[k][node] -> Node reached after 2^k full pattern passes
+// > hits[k][node]   -> A stop node is reached during those 2^k passes
+struct PatternJumps {
+	std::vector<std::vector<NodeId>> passes{};
+	std::vector<std::vector<bool>> hits{};
+};
+
+// Maximum number of full pattern passes covered by the table is 2^MAX_JUMP_LEVELS
+constexpr int MAX_JUMP_LEVELS = 40;
+
+//
+// Moves a position a given number of steps, starting at a given pattern index
+//
+NodeId walk_steps(const Network& network, const Pattern& pattern, NodeId position, size_t pattern_index, long steps) {
+	const NodeId* children[2]{network.left.data(), network.right.data()};
+	for (long i{0}; i < steps; ++i) {
+		position = children[pattern[(pattern_index + i) % pattern.size()]][position];
+	}
+	return position;
+}
+
 template<typename Condition>
-long find_steps_to_stop(const Map& map, const std::string& pattern, const std::string& initial_pos, Condition stop_condition) {
-	// Check if start position exists
-	if (map.find(initial_pos) == map.cend()) { return 0; }
+PatternPass build_pattern_pass(const Network& network, const Pattern& pattern, Condition stop_condition) {
+	const NodeId* children[2]{network.left.data(), network.right.data()};
+	const size_t n_nodes = network.left.size();
 
-	// Relevant variables for the algorithm
-	long steps{0};
-	std::string position{initial_pos};
+	PatternPass pass{};
+	pass.period = pattern.size();
+	pass.next.resize(n_nodes);
+	pass.hits.resize(n_nodes, false);
+	pass.first_hit.resize(n_nodes, 0);
 
-	// Find algorithm
-	while (true) {
-		// Current pattern step
-		const auto& step = pattern[steps++ % pattern.size()];
+	// Simulates a single pass from every node
+	for (NodeId node{0}; node < n_nodes; ++node) {
+		NodeId position{node};
+		for (int step{0}; step < pattern.size(); ++step) {
+			position = children[pattern[step]][position];
+			if (!pass.hits[node] && stop_condition(position)) {
+				pass.hits[node] = true;
+				pass.first_hit[node] = step + 1;
+			}
+		}
+		pass.next[node] = position;
+	}
 
-		// Updates the position
-		position = map.at(position)[step == 'L' ? 0 : 1];
+	return pass;
+}
+
+PatternJumps build_pattern_jumps(const PatternPass& pass) {
+	const size_t n_nodes = pass.next.size();
+
+	PatternJumps jumps{};
+	jumps.passes.push_back(pass.next);
+	jumps.hits.push_back(pass.hits);
+
+	// Doubles the number of passes at each level
+	std::vector<NodeId> passes(n_nodes);
+	std::vector<bool> hits(n_nodes, false);
+	for (int level{1}; level < MAX_JUMP_LEVELS; ++level) {
+		const auto& prev_passes = jumps.passes.back();
+		const auto& prev_hits = jumps.hits.back();
+
+		for (NodeId node{0}; node < n_nodes; ++node) {
+			passes[node] = prev_passes[prev_passes[node]];
+			hits[node] = prev_hits[node] || prev_hits[prev_passes[node]];
+		}
 
-		// Check the stop condition
-		if (stop_condition(position)) { break; }
+		jumps.passes.push_back(passes);
+		jumps.hits.push_back(hits);
 	}
 
-	return steps;
+	return jumps;
 }
 
+//
+// Node reached from a given position after a given number of steps
+// > Full passes are lifted in O(log K), only the remaining steps (less than a pass) are simulated
+//
+NodeId find_node_after(const PatternPass& pass, const PatternJumps& jumps, const Network& network, const Pattern& pattern, NodeId position, long steps) {
+	long passes = steps / pass.period;
+	for (int level{0}; passes > 0 && level < MAX_JUMP_LEVELS; ++level, passes >>= 1) {
+		if (passes & 1) { position = jumps.passes[level][position]; }
+	}
+	return walk_steps(network, pattern, position, 0, steps % pass.period);
+}
+
+//
+// Steps until the first stop node is reached from a given position (-1 if never reached)
+// > Skips, from the biggest level down, every block of passes without stop nodes
+//
+long find_steps_to_stop(const PatternPass& pass, const PatternJumps& jumps, NodeId position) {
+	if (!jumps.hits[MAX_JUMP_LEVELS - 1][position]) { return -1; }
+
+	long passes{0};
+	for (int level{MAX_JUMP_LEVELS - 1}; level >= 0; --level) {
+		if (!jumps.hits[level][position]) {
+			position = jumps.passes[level][position];
+			passes += 1L << level;
+		}
+	}
+
+	return passes * pass.period + pass.first_hit[position];
+}
+
+// Walk of a single start position, described as a tail followed by an endless cycle
+// > Steps after 'tail' repeat every 'period' steps
+// > tail_hits  -> Steps in [1, tail] where a stop node is reached
+// > cycle_hits -> Steps in [tail + 1, tail + period] where a stop node is reached
+struct WalkCycle {
+	long tail{0};
+	long period{0};
+	std::vector<long> tail_hits{};
+	std::vector<long> cycle_hits{};
+};
+
+using Int128 = __int128;
+
+//
+// Analyzes the walk of a given start position
+// > The walk state is (node, pattern index), which is fully determined by the node at every pattern index 0
+// > Brent's algorithm therefore runs over the single pass table, giving tail and period in full passes
+//
 template<typename Condition>
-std::vector<std::string> find_start_positions(const Map& map, Condition found_condition) {
-	std::vector<std::string> start_positions{};
+WalkCycle analyze_walk(const PatternPass& pass, const Network& network, const Pattern& pattern, NodeId start, Condition stop_condition) {
+	const auto& next_pass = pass.next;
+
+	// Brent's algorithm: period
+	long power{1}, period{1};
+	NodeId tortoise{start};
+	NodeId hare{next_pass[start]};
+	while (tortoise != hare) {
+		if (power == period) {
+			tortoise = hare;
+			power *= 2;
+			period = 0;
+		}
+		hare = next_pass[hare];
+		++period;
+	}
+
+	// Brent's algorithm: tail
+	long tail{0};
+	tortoise = hare = start;
+	for (long i{0}; i < period; ++i) { hare = next_pass[hare]; }
+	while (tortoise != hare) {
+		tortoise = next_pass[tortoise];
+		hare = next_pass[hare];
+		++tail;
+	}
+
+	WalkCycle walk{tail * pass.period, period * pass.period};
+
+	// Collects every stop node reached during the tail and the first cycle
+	const NodeId* children[2]{network.left.data(), network.right.data()};
+	NodeId position{start};
+	for (long step{1}; step <= walk.tail + walk.period; ++step) {
+		position = children[pattern[(step - 1) % pattern.size()]][position];
+		if (!stop_condition(position)) { continue; }
+		(step <= walk.tail ? walk.tail_hits : walk.cycle_hits).push_back(step);
+	}
+
+	return walk;
+}
 
-	for (const auto& option : map) {
-		if (found_condition(option.first)) {
-			start_positions.push_back(option.first);
+//
+// Checks if a walk is on a stop node at a given step
+//
+bool is_walk_hit(const WalkCycle& walk, long step) {
+	if (step <= walk.tail) {
+		return std::binary_search(walk.tail_hits.cbegin(), walk.tail_hits.cend(), step);
+	}
+	const long cycle_step = walk.tail + 1 + (step - walk.tail - 1) % walk.period;
+	return std::binary_search(walk.cycle_hits.cbegin(), walk.cycle_hits.cend(), cycle_step);
+}
+
+// Congruence: value = residue (mod modulus)
+struct Congruence {
+	Int128 residue{0};
+	Int128 modulus{1};
+};
+
+//
+// Greatest common divisor (std::gcd does not accept 128-bit integers in strict ISO mode)
+//
+Int128 gcd(Int128 lhs, Int128 rhs) {
+	while (rhs != 0) {
+		lhs %= rhs;
+		std::swap(lhs, rhs);
+	}
+	return lhs;
+}
+
+//
+// Modular inverse of a value, given that it is coprime with the modulus
+//
+Int128 modular_inverse(Int128 value, Int128 modulus) {
+	Int128 old_r{value % modulus}, r{modulus};
+	Int128 old_s{1}, s{0};
+	while (r != 0) {
+		const Int128 quotient = old_r / r;
+		old_r = old_r - quotient * r; std::swap(old_r, r);
+		old_s = old_s - quotient * s; std::swap(old_s, s);
+	}
+	return ((old_s % modulus) + modulus) % modulus;
+}
+
+//
+// Generalized chinese remainder theorem (moduli do not need to be coprime)
+// > Returns false if both congruences cannot be satisfied at the same time
+//
+bool combine_congruences(const Congruence& lhs, const Congruence& rhs, Congruence& result) {
+	const Int128 g = gcd(lhs.modulus, rhs.modulus);
+	const Int128 difference = rhs.residue - lhs.residue;
+	if (difference % g != 0) { return false; }
+
+	const Int128 rhs_reduced = rhs.modulus / g;
+
+	Int128 modulus{0};
+	if (__builtin_mul_overflow(lhs.modulus, rhs_reduced, &modulus)) {
+		throw std::overflow_error("The combined walk cycles overflow 128-bit arithmetic.");
+	}
+
+	// Both factors are below 'rhs_reduced', which keeps the product within 128 bits
+	Int128 k = ((difference / g) % rhs_reduced + rhs_reduced) % rhs_reduced;
+	k = k * modular_inverse(lhs.modulus / g % rhs_reduced, rhs_reduced) % rhs_reduced;
+
+	result.modulus = modulus;
+	result.residue = (lhs.residue + lhs.modulus * k) % modulus;
+	return true;
+}
+
+//
+// First step where every walk is on a stop node at the same time (-1 if never)
+//
+long find_common_stop(const std::vector<WalkCycle>& walks) {
+	if (walks.empty()) { return -1; }
+
+	auto all_hit = [&walks](long step){
+		return std::all_of(walks.cbegin(), walks.cend(), [step](const WalkCycle& walk){ return is_walk_hit(walk, step); });
+	};
+
+	// Steps before every walk is inside its cycle: checks the hits of the first walk directly
+	const long max_tail = std::max_element(walks.cbegin(), walks.cend(), [](const WalkCycle& lhs, const WalkCycle& rhs){
+		return lhs.tail < rhs.tail;
+	})->tail;
+
+	const auto& first = walks.front();
+	for (const auto& step : first.tail_hits) {
+		if (all_hit(step)) { return step; }
+	}
+	if (!first.cycle_hits.empty()) {
+		for (long offset{0}; first.cycle_hits.front() + offset <= max_tail; offset += first.period) {
+			for (const auto& hit : first.cycle_hits) {
+				if (hit + offset > max_tail) { break; }
+				if (all_hit(hit + offset)) { return hit + offset; }
+			}
 		}
 	}
 
-	return start_positions;
+	// Steps after every walk is inside its cycle: combines the cycle hits of all walks
+	// > Duplicated congruences are merged after each walk, so the candidates never exceed the lcm of
+	//   the periods combined so far (all of them share that modulus)
+	// > Worst case is still min(product of the cycle hits counts, lcm of the periods), e.g. every
+	//   walk hitting a stop node at every step of coprime periods
+	std::vector<Congruence> candidates{Congruence{}};
+	for (const auto& walk : walks) {
+		std::vector<Congruence> next_candidates{};
+		for (const auto& candidate : candidates) {
+			for (const auto& hit : walk.cycle_hits) {
+				Congruence combined{};
+				if (combine_congruences(candidate, Congruence{hit % walk.period, walk.period}, combined)) {
+					next_candidates.push_back(combined);
+				}
+			}
+		}
+
+		auto as_tuple = [](const Congruence& congruence){ return std::tuple{congruence.modulus, congruence.residue}; };
+		std::sort(next_candidates.begin(), next_candidates.end(), [&](const Congruence& lhs, const Congruence& rhs){
+			return as_tuple(lhs) < as_tuple(rhs);
+		});
+		next_candidates.erase(std::unique(next_candidates.begin(), next_candidates.end(), [&](const Congruence& lhs, const Congruence& rhs){
+			return as_tuple(lhs) == as_tuple(rhs);
+		}), next_candidates.end());
+
+		candidates = std::move(next_candidates);
+	}
+	if (candidates.empty()) { return -1; }
+
+	// Smallest step past all the tails that satisfies any of the candidates
+	Int128 result{-1};
+	for (const auto& candidate : candidates) {
+		Int128 step = candidate.residue;
+		if (step <= max_tail) { step += ((max_tail - step) / candidate.modulus + 1) * candidate.modulus; }
+		if (result < 0 || step < result) { result = step; }
+	}
+
+	if (result > std::numeric_limits<long>::max()) {
+		throw std::overflow_error("The first common stop does not fit in 64 bits.");
+	}
+	return static_cast<long>(result);
 }
 
 InputData Day08::ParseInputs(std::ifstream& data) {
     // Actual outputs
-	std::string pattern{};
-    Map map {};
+	Pattern pattern{};
+    Network network {};
 
 	// First line is the moving pattern
-	std::getline(data, pattern);
-
 	std::string line;
+	std::getline(data, line);
+	std::transform(line.cbegin(), line.cend(), std::back_inserter(pattern), [](char step){
+		return static_cast<uint8_t>(step == 'L' ? 0 : 1);
+	});
+
+	// Read every node as packed names
+	std::vector<std::array<int, 3>> nodes{};
 	std::getline(data, line); // Remove empty line
     while(std::getline(data, line)) {
-		const auto from = line.substr(0, 3);
-		const auto left = line.substr(7, 3);
-		const auto right = line.substr(12, 3);
-
-		map[from] = Choice{left, right};
+		nodes.push_back({
+			pack_node_name(line, 0),
+			pack_node_name(line, 7),
+			pack_node_name(line, 12)
+		});
     }
 
-    return {pattern, map};
+	// Interns the packed names into dense ids, following the reading order
+	std::vector<int> ids(36 * 36 * 36, -1);
+	for (int i{0}; i < nodes.size(); ++i) {
+		const int name = nodes[i][0];
+		ids[name] = i;
+		network.starts.push_back(name % 36 == 10);
+		network.ends.push_back(name % 36 == 35);
+	}
+
+	for (const auto& node : nodes) {
+		network.left.push_back(ids[node[1]]);
+		network.right.push_back(ids[node[2]]);
+	}
+
+	network.first = ids[pack_node_name("AAA", 0)];
+	network.last = ids[pack_node_name("ZZZ", 0)];
+
+    return {pattern, network};
 }
 
 long Day08::PartOne(const InputData& data) const {
-	const auto& [pattern, map] = data;
+	const auto& [pattern, network] = data;
+
+	// Check if start position exists
+	if (network.first < 0) { return 0; }
 
 	// Execution conditions
-	const std::string start_position = "AAA";
-	const auto stop_condition = [](const std::string& position){ return position == "ZZZ"; };
+	const auto stop_condition = [&network](NodeId position){ return position == network.last; };
+	const auto pass = build_pattern_pass(network, pattern, stop_condition);
+	const auto jumps = build_pattern_jumps(pass);
 
-	return find_steps_to_stop(map, pattern, start_position, stop_condition);
+	return find_steps_to_stop(pass, jumps, network.first);
 }
 
 long Day08::PartTwo(const InputData& data) const {
-	const auto& [pattern, map] = data;
+	const auto& [pattern, network] = data;
 
 	// Execution conditions
-	const auto found_condition = [](const std::string& position){ return position[2] == 'A'; };
-	const std::vector<std::string> start_positions = find_start_positions(map, found_condition);
-	const auto stop_condition = [](const std::string& position){ return position[2] == 'Z'; };
-
-	return std::accumulate(
-		start_positions.cbegin(), start_positions.cend(), 1L,
-		[&](long result, const std::string& position){
-			long steps = find_steps_to_stop(map, pattern, position, stop_condition);
-			return std::lcm(result, steps);
-		}
-	);
+	const auto stop_condition = [&network](NodeId position){ return network.ends[position]; };
+	const auto pass = build_pattern_pass(network, pattern, stop_condition);
+
+	std::vector<NodeId> start_positions{};
+	for (NodeId position{0}; position < network.starts.size(); ++position) {
+		if (network.starts[position]) { start_positions.push_back(position); }
+	}
+
+	// Analyzes every start position with a bounded pool of threads
+	std::vector<WalkCycle> walks(start_positions.size());
+	parallel_for_each_index(start_positions.size(), worker_count(start_positions.size()), [&](unsigned, size_t i){
+		walks[i] = analyze_walk(pass, network, pattern, start_positions[i], stop_condition);
+	});
+
+	return find_common_stop(walks);
 }
 
 int main(int argc, char* argv[]) {
@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <array>
+#include <numeric>
 #include <iterator>
 #include <string>
 #include <vector>
@@ -8,7 +10,14 @@
 
 using Sequence = std::vector<long>;
 using Sequences = std::vector<Sequence>;
-using InputData = Sequences;
+
+// Sums of the extrapolated values of every sequence, shared by both parts
+struct Extrapolation {
+	long next{0};
+	long previous{0};
+};
+
+using InputData = Extrapolation;
 
 class Day09 : public AoCDay<InputData>
 {
@@ -17,62 +26,80 @@ class Day09 : public AoCDay<InputData>
     long PartTwo(const InputData& data) const override;
 };
 
-Sequence adjacent_difference_sequence(const Sequence& sequence) {
-	Sequence diff_sequence{};
-	std::transform(
-		sequence.cbegin() + 1, sequence.cend(),
-		sequence.cbegin(),
-		std::back_inserter(diff_sequence),
-		[](long last, long first){ return last - first; }
-	);
-	return diff_sequence;
-}
-
-Sequences recursive_adjacent_difference_sequences(const Sequence& sequence) {
-	Sequences diff_sequences{sequence};
-
-	while (std::any_of(
-		diff_sequences.back().cbegin(), diff_sequences.back().cend(),
-		[](const long val){ return val != 0; })
-	) {
-		Sequence next_sequence = adjacent_difference_sequence(diff_sequences.back());
-		diff_sequences.push_back(next_sequence);
+// Number of sequences extrapolated together, one per lane
+constexpr std::size_t LANES = 8;
+
+//
+// Extrapolates a block of sequences of the same length, with in-place differences on a scratch buffer
+// > The buffer is transposed (value i of lane j at i * LANES + j), so every level is plain lane arithmetic
+// > next     = sum of the last value of every differences level
+// > previous = alternating sum of the first value of every differences level
+// > Levels past the first all-zero one stay zero, so every lane runs the same number of levels
+//
+void extrapolate_block(std::vector<long>& buffer, std::size_t length, Extrapolation& result) {
+	std::array<long, LANES> next{}, previous{};
+
+	for (std::size_t level{0}; level < length; ++level) {
+		const std::size_t row_length = length - level;
+		const long* first = buffer.data();
+		const long* last = buffer.data() + (row_length - 1) * LANES;
+
+		for (std::size_t lane{0}; lane < LANES; ++lane) { next[lane] += last[lane]; }
+		if (level % 2) { for (std::size_t lane{0}; lane < LANES; ++lane) { previous[lane] -= first[lane]; } }
+		else           { for (std::size_t lane{0}; lane < LANES; ++lane) { previous[lane] += first[lane]; } }
+
+		for (std::size_t i{0}; i + 1 < row_length; ++i) {
+			long* row = buffer.data() + i * LANES;
+			for (std::size_t lane{0}; lane < LANES; ++lane) {
+				row[lane] = row[lane + LANES] - row[lane];
+			}
+		}
 	}
 
-	return diff_sequences;
-}
-
-long extrapolate_right(const Sequence& sequence, long value) {
-	return sequence.back() + value;
-}
-
-long extrapolate_left(const Sequence& sequence, long value) {
-	return sequence.back() - value;
-}
-
-long recursive_extrapolate_right(const Sequences& sequences) {
-	long output{0};
-
-	for (std::size_t i {sequences.size()}; i >= 2; --i) {
-		output = sequences[i-2].back() + output;
+	for (std::size_t lane{0}; lane < LANES; ++lane) {
+		result.next += next[lane];
+		result.previous += previous[lane];
 	}
-
-	return output;
 }
 
-long recursive_extrapolate_left(const Sequences& sequences) {
-	long output{0};
-
-	for (std::size_t i {sequences.size()}; i >= 2; --i) {
-		output = sequences[i-2].front() - output;
+//
+// Sums the next and previous extrapolated values of every sequence, in a single pass
+// > Sequences are grouped by length and extrapolated LANES at a time (empty lanes are zero)
+//
+Extrapolation extrapolate_sequences(const Sequences& sequences) {
+	std::vector<std::size_t> order(sequences.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs){
+		return sequences[lhs].size() < sequences[rhs].size();
+	});
+
+	Extrapolation result{};
+	std::vector<long> buffer{};
+
+	for (std::size_t begin{0}; begin < order.size(); ) {
+		const std::size_t length = sequences[order[begin]].size();
+
+		std::size_t end{begin};
+		while (end < order.size() && end - begin < LANES && sequences[order[end]].size() == length) { ++end; }
+
+		buffer.assign(length * LANES, 0);
+		for (std::size_t lane{0}; lane < end - begin; ++lane) {
+			const auto& sequence = sequences[order[begin + lane]];
+			for (std::size_t i{0}; i < length; ++i) {
+				buffer[i * LANES + lane] = sequence[i];
+			}
+		}
+
+		extrapolate_block(buffer, length, result);
+		begin = end;
 	}
 
-	return output;
+	return result;
 }
 
 InputData Day09::ParseInputs(std::ifstream& data) {
 	// Actual outputs
-	InputData sequences{};
+	Sequences sequences{};
 
 	std::string line;
     while(std::getline(data, line)) {
@@ -88,31 +115,15 @@ InputData Day09::ParseInputs(std::ifstream& data) {
 		sequences.push_back(sequence);
     }
 
-    return sequences;
+    return extrapolate_sequences(sequences);
 }
 
 long Day09::PartOne(const InputData& data) const {
-	long result{0};
-
-	for (const auto& sequence : data) {
-		InputData diff_sequences = recursive_adjacent_difference_sequences(sequence);
-		long extrapolated_value = recursive_extrapolate_right(diff_sequences);
-		result += extrapolated_value;
-	}
-
-	return result;
+	return data.next;
 }
 
 long Day09::PartTwo(const InputData& data) const {
-	long result{0};
-
-	for (const auto& sequence : data) {
-		InputData diff_sequences = recursive_adjacent_difference_sequences(sequence);
-		long extrapolated_value = recursive_extrapolate_left(diff_sequences);
-		result += extrapolated_value;
-	}
-
-	return result;
+	return data.previous;
 }
 
 int main(int argc, char* argv[]) {
@@ -1,9 +1,10 @@
 #include <algorithm>
-#include <tuple>
-#include <unordered_map>
+#include <array>
 #include <vector>
 #include <string>
-#include <map>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
 
 #include "../common/utils.hpp"
 #include "../common/AoCDay.hpp"
@@ -13,21 +14,37 @@ struct Pipe {
 	long y{0};
 };
 
-const std::map<char, Pipe> DIRECTIONS {
-	{'E', { 1, 0}},
-	{'W', {-1, 0}},
-	{'S', {0 , 1}},
-	{'N', {0 ,-1}}
+// Flow directions as integers, where the opposite direction is (dir ^ 2)
+enum Direction : uint8_t {
+	North = 0,
+	East,
+	South,
+	West,
+	NoDirection = 0xFF
 };
 
-const std::unordered_map<char, char> EDGE_PIPES_CLOSING_MATCH {
-	{'F', 'J'},
-	{'L', '7'}
+constexpr std::array<long, 4> DIRECTION_X{0, 1, 0, -1};
+constexpr std::array<long, 4> DIRECTION_Y{-1, 0, 1, 0};
+
+// Pipe map stored as a single flat grid, surrounded by a border of empty tiles
+// > The border removes every bounds check from the loop walk
+struct PipeMap {
+	std::string tiles{};
+	long width{0};
+	long start{0};
+};
+
+// Result of a single traversal of the pipe loop, shared by both parts
+// > vertices -> Pipes where the flow changes direction (polygon corners)
+// > length   -> Number of pipes in the loop
+// > area     -> Polygon area enclosed by the loop pipes centers (shoelace formula)
+struct LoopAnalysis {
+	std::vector<Pipe> vertices{};
+	long length{0};
+	long area{0};
 };
 
-using PipeMap = std::vector<std::string>;
-using PipeSystem = std::vector<Pipe>;
-using InputData = std::tuple<PipeMap, Pipe>;
+using InputData = LoopAnalysis;
 
 class Day10 : public AoCDay<InputData>
 {
@@ -36,279 +53,140 @@ class Day10 : public AoCDay<InputData>
     long PartTwo(const InputData& data) const override;
 };
 
-InputData Day10::ParseInputs(std::ifstream& data) {
-	// Actual outputs
-	PipeMap pipe_map{};
-	Pipe start_position{};
+//
+// Connectivity of every glyph, as a 4-bit mask of the directions it connects to
+//
+constexpr std::array<uint8_t, 256> make_pipe_connections() {
+	std::array<uint8_t, 256> connections{};
+	connections['|'] = (1 << North) | (1 << South);
+	connections['-'] = (1 << East) | (1 << West);
+	connections['L'] = (1 << North) | (1 << East);
+	connections['J'] = (1 << North) | (1 << West);
+	connections['7'] = (1 << South) | (1 << West);
+	connections['F'] = (1 << South) | (1 << East);
+	return connections;
+}
 
-	long y_counter{0};
-	std::string line;
-    while(std::getline(data, line)) {
-		pipe_map.push_back(line);
-		const auto start_pos = line.find('S');
-		if (start_pos != -1) {
-			start_position.x = static_cast<long>(start_pos);
-			start_position.y = y_counter;
+constexpr auto PIPE_CONNECTIONS = make_pipe_connections();
+
+//
+// Outgoing direction for every (incoming direction, glyph) pair
+// > The pipe is entered through the side opposite to the incoming direction, and left through its other side
+// > Glyphs that cannot be entered from the incoming direction map to NoDirection
+//
+constexpr std::array<std::array<uint8_t, 256>, 4> make_pipe_flows() {
+	std::array<std::array<uint8_t, 256>, 4> flows{};
+	for (int dir{0}; dir < 4; ++dir) {
+		for (int glyph{0}; glyph < 256; ++glyph) {
+			const uint8_t entry = 1 << (dir ^ 2);
+			const uint8_t connections = PIPE_CONNECTIONS[glyph];
+			flows[dir][glyph] = (connections & entry) ? std::countr_zero<uint8_t>(connections & ~entry) : NoDirection;
 		}
-		++y_counter;
-    }
-
-	return {pipe_map, start_position};
+	}
+	return flows;
 }
 
-// Utility function to check if two pipes are the same
-bool operator==(const Pipe& lhs, const Pipe& rhs) {
-	return (lhs.x == rhs.x) && (lhs.y == rhs.y);
-}
+constexpr auto PIPE_FLOWS = make_pipe_flows();
 
-bool is_inside_map(const PipeMap& map, const Pipe& pipe) {
-	// Map grid limits
-	const auto map_x_range = map[0].size();
-	const auto map_y_range = map.size();
+//
+// Infers the starting pipe connections from the neighbors pointing back at it
+//
+uint8_t find_start_connections(const PipeMap& map) {
+	const long offsets[4]{-map.width, 1, map.width, -1};
 
-	// Check
-	if (pipe.x < 0 || pipe.x >= map_x_range || pipe.y < 0 || pipe.y >= map_y_range) {
-		return false;
+	uint8_t connections{0};
+	for (int dir{0}; dir < 4; ++dir) {
+		const uint8_t neighbor = PIPE_CONNECTIONS[static_cast<uint8_t>(map.tiles[map.start + offsets[dir]])];
+		connections |= ((neighbor >> (dir ^ 2)) & 1) << dir;
 	}
 
-	return true;
+	return connections;
 }
 
-char find_start_position_pipe(const PipeMap& map, const Pipe& starting_pipe) {
-	// Possible candidates for the starting pipe will be stored here
-	std::map<char, int> candidates{};
-
-	// Checks the pipe surroudings in all directions
-	for (const auto& [dir, vec] : DIRECTIONS) {
-		// Calculates the current adjacent pipe position
-		const Pipe next_pipe {
-			starting_pipe.x + vec.x,
-			starting_pipe.y + vec.y
-		};
-
-		// Do not proceed if outside the pipe map grid
-		if (!is_inside_map(map, next_pipe)) { continue; }
-
-		// Gets the symbol in the pipe position
-		const char& symbol = map[next_pipe.y][next_pipe.x];
-
-		// Deciphers the possible candidates based on the current adjacent pipe
-		if (dir == 'N') {
-			if (symbol == '|') { ++candidates['J']; ++candidates['L']; ++candidates['|']; }
-			if (symbol == 'F') { ++candidates['J']; ++candidates['L']; ++candidates['|']; }
-			if (symbol == '7') { ++candidates['J']; ++candidates['L']; ++candidates['|']; }
-		} else if (dir == 'S') {
-			if (symbol == '|') { ++candidates['7']; ++candidates['F']; ++candidates['|']; }
-			if (symbol == 'L') { ++candidates['7']; ++candidates['F']; ++candidates['|']; }
-			if (symbol == 'J') { ++candidates['7']; ++candidates['F']; ++candidates['|']; }
-		} else if (dir == 'E') {
-			if (symbol == '-') { ++candidates['F']; ++candidates['L']; ++candidates['-']; }
-			if (symbol == 'J') { ++candidates['F']; ++candidates['L']; ++candidates['-']; }
-			if (symbol == '7') { ++candidates['F']; ++candidates['L']; ++candidates['-']; }
-		} else if (dir == 'W') {
-			if (symbol == '-') { ++candidates['7']; ++candidates['J']; ++candidates['-']; }
-			if (symbol == 'L') { ++candidates['7']; ++candidates['J']; ++candidates['-']; }
-			if (symbol == 'F') { ++candidates['7']; ++candidates['J']; ++candidates['-']; }
-		}
-	}
+LoopAnalysis analyze_loop(const PipeMap& map) {
+	LoopAnalysis loop{};
 
-	// Returns the best candidate (should be the only one with 2 as counter)
-	return std::max_element(
-		candidates.cbegin(), candidates.cend(),
-		[](const std::pair<char, int>& lhs, const std::pair<char, int>& rhs){
-			return lhs.second < rhs.second;
-		}
-	)->first;
-}
+	const long offsets[4]{-map.width, 1, map.width, -1};
 
-char find_start_search_flow(const PipeMap& map, const Pipe& starting_pipe) {
-	// Checks the pipe surroudings in all directions
-	for (const auto& [dir, vec] : DIRECTIONS) {
-		// Calculates the current adjacent pipe position
-		const Pipe next_pipe {
-			starting_pipe.x + vec.x,
-			starting_pipe.y + vec.y
-		};
-
-		// Do not proceed if outside the pipe map grid
-		if (!is_inside_map(map, next_pipe)) { continue; }
-
-		// Gets the symbol in the pipe position
-		const char& symbol = map[next_pipe.y][next_pipe.x];
-
-		// Checks if for the current direction the adjacent pipe allows to flow with the starting pipe
-		if (dir == 'N') {
-			if (symbol == '|') { return 'N'; }
-			if (symbol == 'F') { return 'N'; }
-			if (symbol == '7') { return 'N'; }
-		} else if (dir == 'S') {
-			if (symbol == '|') { return 'S'; }
-			if (symbol == 'L') { return 'S'; }
-			if (symbol == 'J') { return 'S'; }
-		} else if (dir == 'E') {
-			if (symbol == '-') { return 'E'; }
-			if (symbol == 'J') { return 'E'; }
-			if (symbol == '7') { return 'E'; }
-		} else if (dir == 'W') {
-			if (symbol == '-') { return 'W'; }
-			if (symbol == 'L') { return 'W'; }
-			if (symbol == 'F') { return 'W'; }
-		}
-	}
+	// Get a starting search direction
+	const uint8_t start_connections = find_start_connections(map);
+	if (start_connections == 0) { return loop; }
+	const uint8_t start_direction = std::countr_zero(start_connections);
 
-	// If we ever reach here we have a problem :D
-	return {};
-}
+	long position{map.start};
+	long x{map.start % map.width}, y{map.start / map.width};
+	uint8_t direction{start_direction};
+	long double_area{0};
 
-std::tuple<Pipe, char> find_next_flow_pipe(const PipeMap& map, const Pipe& pipe, char dir) {
-	// Gets the vector for the current search direction
-	const auto& vec = DIRECTIONS.at(dir);
+	while(true) {
+		// Moves to the next pipe
+		position += offsets[direction];
+		const long next_x = x + DIRECTION_X[direction];
+		const long next_y = y + DIRECTION_Y[direction];
 
-	// Calculates the adjacent pipe position
-	const Pipe next_pipe {
-		pipe.x + vec.x,
-		pipe.y + vec.y
-	};
+		// Shoelace formula term of the current loop edge
+		double_area += x * next_y - next_x * y;
+		++loop.length;
 
-	// Do not proceed if outside the pipe map grid
-	if (!is_inside_map(map, next_pipe)) {
-		return { Pipe{-1, -1}, {} }; // Dummy output
-	}
+		x = next_x;
+		y = next_y;
 
-	// Gets the symbol in the pipe position
-	const char& symbol = map[next_pipe.y][next_pipe.x];
-
-	// If by any change we reach the starting position
-	if (symbol == 'S') { return {next_pipe, {}}; }
-
-	// Find the next search direction based on the symbol of the adjacent pipe
-	if (dir == 'N') {
-		if (symbol == '|') { return {next_pipe, 'N'}; }
-		if (symbol == 'F') { return {next_pipe, 'E'}; }
-		if (symbol == '7') { return {next_pipe, 'W'}; }
-	} else if (dir == 'S') {
-		if (symbol == '|') { return {next_pipe, 'S'}; }
-		if (symbol == 'L') { return {next_pipe, 'E'}; }
-		if (symbol == 'J') { return {next_pipe, 'W'}; }
-	} else if (dir == 'E') {
-		if (symbol == '-') { return {next_pipe, 'E'}; }
-		if (symbol == 'J') { return {next_pipe, 'N'}; }
-		if (symbol == '7') { return {next_pipe, 'S'}; }
-	} else if (dir == 'W') {
-		if (symbol == '-') { return {next_pipe, 'W'}; }
-		if (symbol == 'L') { return {next_pipe, 'N'}; }
-		if (symbol == 'F') { return {next_pipe, 'S'}; }
-	}
+		// Check if the loop was reached
+		// > The starting pipe is a vertex if the loop does not leave it in the same direction it arrives
+		if (position == map.start) {
+			if (direction != start_direction) { loop.vertices.insert(loop.vertices.begin(), Pipe{x - 1, y - 1}); }
+			break;
+		}
 
-	return { Pipe{-1, -1}, {} }; // Dummy output
-}
+		// Find the next search direction
+		const uint8_t next_direction = PIPE_FLOWS[direction][static_cast<uint8_t>(map.tiles[position])];
 
-PipeSystem find_pipe_system(const PipeMap& map, const Pipe& starting_pipe) {
-	PipeSystem pipe_system{starting_pipe};
+		// Check if the loop is broken
+		if (next_direction == NoDirection) { break; }
 
-	// Get a starting search direction
-	char direction = find_start_search_flow(map, starting_pipe);
+		// Direction changes mark the polygon vertices (without the border offset)
+		if (next_direction != direction) { loop.vertices.push_back(Pipe{x - 1, y - 1}); }
 
-	while(true) {
-		// Always analyse the last inserted pipe until we find the loop
-		const auto& pipe = pipe_system.back();
+		direction = next_direction;
+	}
+
+	loop.area = std::abs(double_area) / 2;
 
-		// Find the next flow pipe and search direction
-		const auto [next_pipe, next_dir] = find_next_flow_pipe(map, pipe, direction);
+	return loop;
+}
 
-		// Check if the loop is unreachable
-		if (!is_inside_map(map, next_pipe)) { break; }
+InputData Day10::ParseInputs(std::ifstream& data) {
+	// Actual outputs
+	PipeMap pipe_map{};
 
-		// Check if the loop was reached
-		if (next_pipe == starting_pipe) { break; }
+	std::vector<std::string> lines{};
+	std::string line;
+    while(std::getline(data, line)) {
+		lines.push_back(line);
+    }
 
-		// Updates the search variables
-		direction = next_dir;
-		pipe_system.push_back(next_pipe);
+	// Builds the flat grid with an empty border around it
+	pipe_map.width = lines.empty() ? 2 : lines[0].size() + 2;
+	pipe_map.tiles.assign(pipe_map.width * (lines.size() + 2), '.');
+	for (long y{0}; y < lines.size(); ++y) {
+		std::copy(lines[y].cbegin(), lines[y].cend(), pipe_map.tiles.begin() + (y + 1) * pipe_map.width + 1);
 	}
 
-	return pipe_system;
+	const auto start_pos = pipe_map.tiles.find('S');
+	if (start_pos == std::string::npos) { return {}; }
+	pipe_map.start = static_cast<long>(start_pos);
+
+	// The loop is traversed only once, here
+	return analyze_loop(pipe_map);
 }
 
 long Day10::PartOne(const InputData& data) const {
-	const auto& [pipe_map, start_position] = data;
-
-	const auto pipe_system = find_pipe_system(pipe_map, start_position);
-	return pipe_system.size() / 2;
+	return data.length / 2;
 }
 
+// Pick's theorem: area = inside_points + boundary_points / 2 - 1
 long Day10::PartTwo(const InputData& data) const {
-	const auto& [pipe_map, start_position] = data;
-
-	const auto pipe_system = find_pipe_system(pipe_map, start_position);
-
-	// Creates a clean pipe map full of empty spaces
-	PipeMap clean_pipe_map{};
-	clean_pipe_map.resize(pipe_map.size(), std::string(pipe_map[0].size(), '.'));
-
-	// Fills the clean pipe map with only the pipe system
-	for (const auto& pipe : pipe_system) {
-		clean_pipe_map[pipe.y][pipe.x] = pipe_map[pipe.y][pipe.x];
-	}
-
-	// Replaces the S symbol with its corresponding pipe symbol
-	clean_pipe_map[start_position.y][start_position.x] = find_start_position_pipe(pipe_map, start_position);
-
-	// Actual search algorithm
-	// > Raycasting in all the map rows
-	// > - Everytime a delimiter pipe symbol is found (lets call it frontier), there is a transition
-	//    between outside and inside regime;
-	//     - The transition causes the raycast to increase its current value by 1
-	// > - In edge cases (L, J, 7, F) is found, another edge symbol will be found at the end of the
-	//    pipe segment. It is necessary to find if it is a closing edge creating a frontier, or not
-	//     - Closing edges    : FJ and L7
-	//     - Not closing edges: F7 and LJ
-	//     - Note: Best way to imagine this is to project its shadow. FJ or L7 projected allow the
-	//            creation of the symbol '|' as their shadow, while the others only half of it.
-	// > - In not closing edges scenarios, and additional increment of the raycast must be done
-	//    to restore its previous status before encoutering the starting pipe of the segment (F or L)
-	long inside_points{0};
-	for (int y{0}; y < clean_pipe_map.size(); ++y) {
-		// Variable that will control the raycast status of the current row
-		int raycast_status{0};
-
-		for (int x{0}; x < clean_pipe_map[y].size(); ++x) {
-			// Current symbol under analysis
-			auto symbol = clean_pipe_map[y][x];
-
-			// If it is a pipe symbol
-			if (symbol != '.') {
-				// Update raycast status
-				++raycast_status;
-
-				// If it is a edge case
-				if (std::string("FL").find(symbol) != -1) {
-					// Get the expected symbol to be a closing segment
-					const auto& expected_closing_match = EDGE_PIPES_CLOSING_MATCH.at(symbol);
-
-					// Search for the end edge in the pipe segment
-					do {
-						++x;
-						symbol = clean_pipe_map[y][x];
-					}
-					while (std::string("7J").find(symbol) == -1);
-
-					// Update the raycast status if the end edge does not make a closing match
-					if (symbol != expected_closing_match) {
-						++raycast_status;
-					}
-				}
-				continue;
-			}
-
-			// If reached here, no pipe symbol was found. Increate inner point if raycast status says it is inside
-			if (raycast_status % 2 == 1) {
-				++inside_points;
-			}
-		}
-	}
-
-	return inside_points;
+	return data.area - data.length / 2 + 1;
 }
 
 int main(int argc, char* argv[]) {
@@ -1,5 +1,3 @@
-#include <numeric>
-#include <tuple>
 #include <vector>
 
 #include "../common/utils.hpp"
@@ -10,11 +8,31 @@ struct Position {
 	long y{0};
 };
 
-using GraphLine = std::vector<long>;
-using Graph = std::vector<GraphLine>;
 using EmptySpace = std::vector<bool>;
 using Galaxies = std::vector<Position>;
-using InputData = std::tuple<Galaxies, EmptySpace, EmptySpace>;
+
+// Total distance between every pair of galaxies, as an affine function of the expansion factor
+// > distance(factor) = base + (factor - 1) * crossings
+// > base      -> Total distance without any expansion
+// > crossings -> Total number of empty lines crossed by all the pairs
+struct ExpansionDistances {
+	long base{0};
+	long crossings{0};
+
+	long distance(long factor) const {
+		return base + (factor - 1) * crossings;
+	}
+
+	std::vector<long> distances(const std::vector<long>& factors) const {
+		std::vector<long> results{};
+		for (const auto& factor : factors) {
+			results.push_back(distance(factor));
+		}
+		return results;
+	}
+};
+
+using InputData = ExpansionDistances;
 
 class Day11 : public AoCDay<InputData>
 {
@@ -23,6 +41,8 @@ class Day11 : public AoCDay<InputData>
     long PartTwo(const InputData& data) const override;
 };
 
+ExpansionDistances compute_expansion_distances(const Galaxies& galaxies, const EmptySpace& h_empty_space, const EmptySpace& v_empty_space);
+
 InputData Day11::ParseInputs(std::ifstream& data) {
 	// Actual outputs
 	Galaxies galaxies{};
@@ -49,76 +69,63 @@ InputData Day11::ParseInputs(std::ifstream& data) {
 		++y;
 	} while(std::getline(data, line));
 
-	return {galaxies, h_empty_space, v_empty_space};
+	return compute_expansion_distances(galaxies, h_empty_space, v_empty_space);
 }
 
-Graph compute_graph(const Galaxies& galaxies, const EmptySpace& h_empty_space, const EmptySpace& v_empty_space, int empty_space_amount) {
-	Graph graph( galaxies.size(), GraphLine(galaxies.size(), 0) );
-
-	for (int i{0}; i < galaxies.size(); ++i) {
-		const auto& v1 = galaxies[i];
-		for (int j{i+1}; j < galaxies.size(); ++j) {
-			const auto& v2 = galaxies[j];
-
-			const long x_min = std::min(v1.x, v2.x);
-			const long x_max = std::max(v1.x, v2.x);
-			const long y_min = std::min(v1.y, v2.y);
-			const long y_max = std::max(v1.y, v2.y);
-
-			const long x_spaces_expansion = std::accumulate(
-				h_empty_space.cbegin() + y_min, h_empty_space.cbegin() + y_max, 0L,
-				[&](long result, bool space){
-					return result + (space ? empty_space_amount - 1 : 0);
-				}
-			);
-
-			const long y_spaces_expansion = std::accumulate(
-				v_empty_space.cbegin() + x_min, v_empty_space.cbegin() + x_max, 0L,
-				[&](long result, bool space){
-					return result + (space ? empty_space_amount - 1 : 0);
-				}
-			);
-
-			long x_distance = x_max - x_min + x_spaces_expansion;
-			long y_distance = y_max - y_min + y_spaces_expansion;
-			long total_distance = x_distance + y_distance;
-
-			graph[i][j] = total_distance;
-			graph[j][i] = total_distance;
-		}
+//
+// Distance coefficients between every pair of galaxies along a single axis
+// > Galaxies are counted per line, which sorts their coordinates in O(n + W)
+// > Walking lines in order, each galaxy adds its distance to all the galaxies already seen:
+//    count * (coordinate * seen - sum of the seen coordinates)
+// > The same sweep runs over the raw coordinates (base) and over the empty lines before each line (crossings)
+//
+ExpansionDistances axis_expansion_distances(const std::vector<long>& coordinates, const EmptySpace& empty_space) {
+	std::vector<long> galaxies_per_line(empty_space.size(), 0);
+	for (const auto& coordinate : coordinates) {
+		++galaxies_per_line[coordinate];
 	}
 
-	return graph;
-}
+	ExpansionDistances result{};
+	long empty_lines{0};
+	long seen{0};
+	long seen_coordinates_sum{0};
+	long seen_empty_lines_sum{0};
 
-long Day11::PartOne(const InputData& data) const {
-	const auto& [galaxies, h_empty_space, v_empty_space] = data;
+	for (long line{0}; line < empty_space.size(); ++line) {
+		const long count = galaxies_per_line[line];
 
-	const auto graph = compute_graph(galaxies, h_empty_space, v_empty_space, 2);
+		result.base += count * (line * seen - seen_coordinates_sum);
+		result.crossings += count * (empty_lines * seen - seen_empty_lines_sum);
 
-	long result{0};
-	for (int i{0}; i < graph.size(); ++i) {
-		for (int j{i+1}; j < graph.size(); ++j) {
-			result += graph[i][j];
-		}
+		seen += count;
+		seen_coordinates_sum += count * line;
+		seen_empty_lines_sum += count * empty_lines;
+
+		empty_lines += empty_space[line];
 	}
 
 	return result;
 }
 
-long Day11::PartTwo(const InputData& data) const {
-	const auto& [galaxies, h_empty_space, v_empty_space] = data;
+ExpansionDistances compute_expansion_distances(const Galaxies& galaxies, const EmptySpace& h_empty_space, const EmptySpace& v_empty_space) {
+	std::vector<long> xs{}, ys{};
+	for (const auto& galaxy : galaxies) {
+		xs.push_back(galaxy.x);
+		ys.push_back(galaxy.y);
+	}
 
-	const auto graph = compute_graph(galaxies, h_empty_space, v_empty_space, 1000000);
+	const auto x_distances = axis_expansion_distances(xs, v_empty_space);
+	const auto y_distances = axis_expansion_distances(ys, h_empty_space);
 
-	long result{0};
-	for (int i{0}; i < graph.size(); ++i) {
-		for (int j{i+1}; j < graph.size(); ++j) {
-			result += graph[i][j];
-		}
-	}
+	return {x_distances.base + y_distances.base, x_distances.crossings + y_distances.crossings};
+}
 
-	return result;
+long Day11::PartOne(const InputData& data) const {
+	return data.distance(2);
+}
+
+long Day11::PartTwo(const InputData& data) const {
+	return data.distance(1000000);
 }
 
 int main(int argc, char* argv[]) {
@@ -2,11 +2,40 @@
 #include <numeric>
 #include <vector>
 #include <string>
+#include <bit>
+#include <cstdint>
+#include <unordered_map>
 
 #include "../common/utils.hpp"
 #include "../common/AoCDay.hpp"
 
-using Platform = std::vector<std::string>;
+// Grid of bits, stored line by line, where each line spans 'words' 64-bit words
+struct BitGrid {
+	long lines{0};
+	long words{0};
+	std::vector<uint64_t> bits{};
+};
+
+// Range of a line between two walls
+struct Segment {
+	long begin{0};
+	long end{0};
+};
+
+using Segments = std::vector<std::vector<Segment>>;
+
+// Platform stored as bitboards
+// > rocks           -> Round rocks, by rows (bit 'x' of line 'y')
+// > row_segments    -> Wall-free ranges of every row
+// > column_segments -> Wall-free ranges of every column
+struct Platform {
+	long width{0};
+	long height{0};
+	BitGrid rocks{};
+	Segments row_segments{};
+	Segments column_segments{};
+};
+
 using InputData = Platform;
 
 class Day14 : public AoCDay<InputData>
@@ -16,93 +45,114 @@ class Day14 : public AoCDay<InputData>
     long PartTwo(const InputData& data) const override;
 };
 
-void TiltNorth(Platform& platform) {
-	for (long y{1}; y < platform.size(); ++y) {
-		for (long x{0}; x < platform[y].size(); ++x) {
-			auto& symbol = platform[y][x];
-
-			if (symbol == 'O') {
-				long y_s{y-1};
-				while(y_s >= 0 && platform[y_s][x] != 'O' && platform[y_s][x] != '#') {
-					--y_s;
-				}
+BitGrid make_bit_grid(long lines, long bits_per_line) {
+	const long words = (bits_per_line + 63) / 64;
+	return {lines, words, std::vector<uint64_t>(lines * words, 0)};
+}
 
-				symbol = '.';
-				platform[y_s+1][x] = 'O';
-			}
+//
+// Transposes a 64x64 bit block in place (bit 'j' of a[i] <-> bit 'i' of a[j])
+//
+void transpose_block(uint64_t block[64]) {
+	uint64_t mask = 0x00000000FFFFFFFFULL;
+	for (int j{32}; j != 0; j >>= 1, mask ^= mask << j) {
+		for (int k{0}; k < 64; k = ((k | j) + 1) & ~j) {
+			const uint64_t t = ((block[k] >> j) ^ block[k | j]) & mask;
+			block[k] ^= t << j;
+			block[k | j] ^= t;
 		}
 	}
 }
 
-void TiltWest(Platform& platform) {
-	for (long x{1}; x < platform[0].size(); ++x) {
-		for (long y{0}; y < platform.size(); ++y) {
-			auto& symbol = platform[y][x];
-
-			if (symbol == 'O') {
-				long x_s{x-1};
-				while(x_s >= 0 && platform[y][x_s] != 'O' && platform[y][x_s] != '#') {
-					--x_s;
-				}
+//
+// Transposes a bit grid, block by block, so that line 'i' bit 'j' becomes line 'j' bit 'i'
+//
+void transpose_grid(const BitGrid& grid, BitGrid& transposed, long bits_per_line) {
+	uint64_t block[64];
 
-				symbol = '.';
-				platform[y][x_s+1] = 'O';
+	for (long line_block{0}; line_block < grid.lines; line_block += 64) {
+		for (long word{0}; word < grid.words; ++word) {
+			for (long i{0}; i < 64; ++i) {
+				block[i] = line_block + i < grid.lines ? grid.bits[(line_block + i) * grid.words + word] : 0;
 			}
-		}
-	}
-}
 
-void TiltSouth(Platform& platform) {
-	for (long y = platform.size() - 2; y >= 0; --y) {
-		for (long x{0}; x < platform[y].size(); ++x) {
-			auto& symbol = platform[y][x];
+			transpose_block(block);
 
-			if (symbol == 'O') {
-				long y_s{y+1};
-				while(y_s < platform.size() && platform[y_s][x] != 'O' && platform[y_s][x] != '#') {
-					++y_s;
-				}
-
-				symbol = '.';
-				platform[y_s-1][x] = 'O';
+			for (long i{0}; i < 64 && word * 64 + i < bits_per_line; ++i) {
+				transposed.bits[(word * 64 + i) * transposed.words + line_block / 64] = block[i];
 			}
 		}
 	}
 }
 
-void TiltEast(Platform& platform) {
-	for (long x = platform[0].size() - 2; x >= 0; --x) {
-		for (long y{0}; y < platform.size(); ++y) {
-			auto& symbol = platform[y][x];
-
-			if (symbol == 'O') {
-				long x_s{x+1};
-				while(x_s < platform[0].size() && platform[y][x_s] != 'O' && platform[y][x_s] != '#') {
-					++x_s;
-				}
-
-				symbol = '.';
-				platform[y][x_s-1] = 'O';
-			}
-		}
+//
+// Number of set bits of a line in the range [begin, end)
+//
+long count_range(const uint64_t* line, long begin, long end) {
+	long count{0};
+	while (begin < end) {
+		const long word = begin / 64;
+		const long offset = begin % 64;
+		const long size = std::min(64 - offset, end - begin);
+		const uint64_t mask = (size == 64 ? ~0ULL : ((1ULL << size) - 1)) << offset;
+		count += std::popcount(line[word] & mask);
+		begin += size;
 	}
+	return count;
 }
 
-bool operator == (const Platform& lhs, const Platform& rhs) {
-	if (lhs.size() != rhs.size()) { return false; }
-	if (lhs[0].size() != rhs[0].size()) { return false; }
+//
+// Sets or clears the bits of a line in the range [begin, end)
+//
+void fill_range(uint64_t* line, long begin, long end, bool value) {
+	while (begin < end) {
+		const long word = begin / 64;
+		const long offset = begin % 64;
+		const long size = std::min(64 - offset, end - begin);
+		const uint64_t mask = (size == 64 ? ~0ULL : ((1ULL << size) - 1)) << offset;
+		line[word] = value ? (line[word] | mask) : (line[word] & ~mask);
+		begin += size;
+	}
+}
 
-	for (long y{0}; y < lhs.size(); ++y) {
-		for (long x{0}; x < lhs[y].size(); ++x) {
-			if (lhs[y][x] != rhs[y][x]) {
-				return false;
-			}
+//
+// Slides every rock of each line towards the start (or the end) of the line
+// > Segmented compaction: rocks between two walls are counted and refilled from the wall side
+//
+void compact_lines(BitGrid& grid, const Segments& segments, bool towards_start) {
+	for (long line{0}; line < grid.lines; ++line) {
+		uint64_t* bits = grid.bits.data() + line * grid.words;
+		for (const auto& segment : segments[line]) {
+			const long rocks = count_range(bits, segment.begin, segment.end);
+			fill_range(bits, segment.begin, segment.end, false);
+			if (towards_start) { fill_range(bits, segment.begin, segment.begin + rocks, true); }
+			else               { fill_range(bits, segment.end - rocks, segment.end, true); }
 		}
 	}
+}
+
+//
+// Tilts the platform north (or south) through its columns view
+//
+void tilt_vertical(Platform& platform, bool north) {
+	BitGrid columns = make_bit_grid(platform.width, platform.height);
+	transpose_grid(platform.rocks, columns, platform.width);
+	compact_lines(columns, platform.column_segments, north);
+	transpose_grid(columns, platform.rocks, platform.height);
+}
 
-	return true;
+//
+// Tilts the platform west (or east) directly on its rows
+//
+void tilt_horizontal(Platform& platform, bool west) {
+	compact_lines(platform.rocks, platform.row_segments, west);
 }
 
+void TiltNorth(Platform& platform) { tilt_vertical(platform, true); }
+void TiltWest(Platform& platform)  { tilt_horizontal(platform, true); }
+void TiltSouth(Platform& platform) { tilt_vertical(platform, false); }
+void TiltEast(Platform& platform)  { tilt_horizontal(platform, false); }
+
 void spin_cycle_platform(Platform& platform) {
 	TiltNorth(platform);
 	TiltWest(platform);
@@ -110,36 +160,118 @@ void spin_cycle_platform(Platform& platform) {
 	TiltEast(platform);
 }
 
-Platform spin_cycle_platform_for(Platform platform, long n_spin_cycles) {
-	std::vector<Platform> cached_spin_cycles{};
+//
+// Total load on the north support beams
+//
+long north_load(const Platform& platform) {
+	long result{0};
+	for (long y{0}; y < platform.height; ++y) {
+		const long rocks = count_range(platform.rocks.bits.data() + y * platform.rocks.words, 0, platform.width);
+		result += rocks * (platform.height - y);
+	}
+	return result;
+}
+
+//
+// Hash of the rocks state
+// > Each word is mixed together with its index (splitmix64), which acts as a per word Zobrist key
+//
+uint64_t hash_rocks(const BitGrid& rocks) {
+	uint64_t hash{0};
+	for (std::size_t i{0}; i < rocks.bits.size(); ++i) {
+		uint64_t z = rocks.bits[i] + (i + 1) * 0x9E3779B97F4A7C15ULL;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		hash ^= z ^ (z >> 31);
+	}
+	return hash;
+}
+
+//
+// Checks if the platform matches the initial platform after a given number of spin cycles
+// > Only needed when two hashes match, so the previous states do not need to be stored
+//
+bool is_state_after_spins(const Platform& initial, long n_spin_cycles, const Platform& platform) {
+	Platform replay = initial;
+	for (long n_spin{0}; n_spin < n_spin_cycles; ++n_spin) {
+		spin_cycle_platform(replay);
+	}
+	return replay.rocks.bits == platform.rocks.bits;
+}
+
+//
+// North load after a given number of spin cycles
+// > Every state is identified by its hash, and only its load is stored
+// > When a hash repeats, the states are fully verified before jumping through the found cycle
+//
+long north_load_after_spin_cycles(const Platform& initial, long n_spin_cycles) {
+	Platform platform = initial;
+
+	std::vector<long> cached_loads{};
+	std::unordered_multimap<uint64_t, long> cached_states{};
 
 	for (long n_spin{0}; n_spin < n_spin_cycles; ++n_spin) {
 		spin_cycle_platform(platform);
 
-		for (long i{0}; i < cached_spin_cycles.size(); ++i) {
-			const auto& previous = cached_spin_cycles[i];
-			if (platform == previous) {
-				const long pattern_start = i;
-				const long pattern_size = cached_spin_cycles.size() - pattern_start;
-				const long remaining_cycles = n_spin_cycles - n_spin - 1;
-				const long final_pos_in_pattern = remaining_cycles % pattern_size;
-				return cached_spin_cycles[pattern_start + final_pos_in_pattern];
-			}
+		const uint64_t hash = hash_rocks(platform.rocks);
+		const auto [first, last] = cached_states.equal_range(hash);
+		for (auto previous = first; previous != last; ++previous) {
+			const long pattern_start = previous->second;
+			if (!is_state_after_spins(initial, pattern_start + 1, platform)) { continue; }
+
+			const long pattern_size = cached_loads.size() - pattern_start;
+			const long remaining_cycles = n_spin_cycles - n_spin - 1;
+			const long final_pos_in_pattern = remaining_cycles % pattern_size;
+			return cached_loads[pattern_start + final_pos_in_pattern];
 		}
 
-		cached_spin_cycles.push_back(platform);
+		cached_states.emplace(hash, n_spin);
+		cached_loads.push_back(north_load(platform));
 	}
 
-	return cached_spin_cycles.back();
+	return north_load(platform);
+}
+
+//
+// Wall-free ranges of a line of tiles
+//
+std::vector<Segment> find_segments(const std::string& line) {
+	std::vector<Segment> segments{};
+	long begin{0};
+	for (long i{0}; i <= line.size(); ++i) {
+		if (i == line.size() || line[i] == '#') {
+			if (i > begin) { segments.push_back({begin, i}); }
+			begin = i + 1;
+		}
+	}
+	return segments;
 }
 
 InputData Day14::ParseInputs(std::ifstream& data) {
 	// Actual outputs
 	Platform platform{};
 
+	std::vector<std::string> lines{};
 	std::string line;
 	while(std::getline(data, line)) {
-		platform.push_back(line);
+		lines.push_back(line);
+	}
+
+	platform.height = lines.size();
+	platform.width = lines.empty() ? 0 : lines[0].size();
+	platform.rocks = make_bit_grid(platform.height, platform.width);
+
+	for (long y{0}; y < platform.height; ++y) {
+		for (long x{0}; x < platform.width; ++x) {
+			if (lines[y][x] == 'O') { fill_range(platform.rocks.bits.data() + y * platform.rocks.words, x, x + 1, true); }
+		}
+		platform.row_segments.push_back(find_segments(lines[y]));
+	}
+
+	for (long x{0}; x < platform.width; ++x) {
+		std::string column(platform.height, '.');
+		for (long y{0}; y < platform.height; ++y) { column[y] = lines[y][x]; }
+		platform.column_segments.push_back(find_segments(column));
 	}
 
 	return platform;
@@ -147,31 +279,13 @@ InputData Day14::ParseInputs(std::ifstream& data) {
 
 long Day14::PartOne(const InputData& data) const {
 	Platform platform = data;
-
 	TiltNorth(platform);
-
-	return std::accumulate(
-		platform.cbegin(), platform.cend(), 0L,
-		[n_rows = platform.size()](long result, const std::string& row){
-			static long line_load{static_cast<long>(n_rows)};
-			long round_rocks = std::count(row.cbegin(), row.cend(), 'O');
-			return result + round_rocks * line_load--;
-		}
-	);
+	return north_load(platform);
 }
 
 long Day14::PartTwo(const InputData& data) const {
 	const long total_spin_cycles = 1000000000;
-	Platform platform = spin_cycle_platform_for(data, total_spin_cycles);
-
-	return std::accumulate(
-		platform.cbegin(), platform.cend(), 0L,
-		[n_rows = platform.size()](long result, const std::string& row){
-			static long line_load{static_cast<long>(n_rows)};
-			long round_rocks = std::count(row.cbegin(), row.cend(), 'O');
-			return result + round_rocks * line_load--;
-		}
-	);
+	return north_load_after_spin_cycles(data, total_spin_cycles);
 }
 
 int main(int argc, char* argv[]) {
@@ -3,33 +3,62 @@
 #include <numeric>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <array>
+#include <memory>
+#include <cstdint>
 
 #include "../common/utils.hpp"
 #include "../common/AoCDay.hpp"
 
-class Sequence
-{
-public:
-	std::string data{};
-	std::string label{};
+// Single step of the initialization sequence
+// > Views point into the input text buffer, nothing is copied
+// > hash -> HASH of the whole step, cached
+// > box  -> HASH of the label, cached
+// > key -> 64-bit hash of the label (FNV-1a), used by the box indexes
+struct Sequence {
+	std::string_view data{};
+	std::string_view label{};
+	uint8_t hash{0};
+	uint8_t box{0};
+	uint64_t key{0};
 	char operation{};
 	long value{0};
+};
 
-	Sequence() = default;
-	Sequence(const std::string& sequence) : data{sequence} {
-		const auto pos = sequence.find_first_of("=-");
-		label = data.substr(0, pos);
-		operation = data[pos];
-		if (operation == '=') {
-			value = std::stol(data.substr(pos + 1));
-		}
-	};
+// Steps of the initialization sequence, together with the text buffer they point into
+// > The buffer is shared, so the views stay valid when the input data is copied
+struct InitializationSequence {
+	std::shared_ptr<const std::string> text{};
+	std::vector<Sequence> steps{};
+};
+
+// Lens stored in a box, linked to its neighbors in insertion order
+struct Lens {
+	std::string_view label{};
+	uint64_t key{0};
+	long value{0};
+	int prev{-1};
+	int next{-1};
+};
+
+// Box of lenses: an insertion-ordered intrusive list, indexed by an open-addressing table
+// > index holds lens ids (-1 if empty), with linear probing over a power of two capacity
+struct LensBox {
+	int head{-1};
+	int tail{-1};
+	int size{0};
+	std::vector<int> index{};
+};
+
+// All the boxes, together with the lenses pool they link into
+struct BoxManager {
+	std::array<LensBox, 256> boxes{};
+	std::vector<Lens> lenses{};
+	std::vector<int> free_lenses{};
 };
 
-using Sequences = std::vector<Sequence>;
-using BoxManager = std::array<Sequences, 256>;
-using InputData = Sequences;
+using InputData = InitializationSequence;
 
 class Day15 : public AoCDay<InputData>
 {
@@ -38,58 +67,193 @@ class Day15 : public AoCDay<InputData>
     long PartTwo(const InputData& data) const override;
 };
 
-long hash_algorithm(const std::string& word) {
-	return std::accumulate(
-		word.cbegin(), word.cend(), 0L,
-		[](long result, const char& c){
-			return ((result + c) * 17) % 256;
+//
+// HASH of a text, one character at a time
+//
+uint8_t hash_text(std::string_view text) {
+	uint8_t hash{0};
+	for (const auto& c : text) {
+		hash = (hash + static_cast<uint8_t>(c)) * 17;
+	}
+	return hash;
+}
+
+//
+// Computes the HASH of every step (and of its label) in a single pass, many steps at a time
+// > HASH is byte arithmetic, (h + c) * 17 mod 256, so each step is one uint8_t lane
+// > Characters are transposed into a column per position, so the lanes loop is plain vectorizable byte code
+// > The label HASH is the intermediate HASH right after the last label character
+// > Lengths are kept in byte lanes too, so steps of 256 characters or more are hashed one by one instead
+//
+void hash_sequences(std::vector<Sequence>& steps) {
+	constexpr std::size_t LANES = 32;
+	constexpr std::size_t MAX_LANE_LENGTH = 255;
+
+	std::vector<std::array<uint8_t, LANES>> columns{};
+
+	for (std::size_t base{0}; base < steps.size(); base += LANES) {
+		const std::size_t n_lanes = std::min(LANES, steps.size() - base);
+
+		// Long steps leave their lane empty
+		std::array<uint8_t, LANES> lengths{}, label_lengths{};
+		std::size_t max_length{0};
+		for (std::size_t lane{0}; lane < n_lanes; ++lane) {
+			auto& step = steps[base + lane];
+			if (step.data.size() > MAX_LANE_LENGTH) {
+				step.hash = hash_text(step.data);
+				step.box = hash_text(step.label);
+				continue;
+			}
+
+			lengths[lane] = step.data.size();
+			label_lengths[lane] = step.label.size();
+			max_length = std::max<std::size_t>(max_length, lengths[lane]);
 		}
-	);
+
+		// Transposes the characters of the steps (zero padded)
+		columns.assign(max_length, {});
+		for (std::size_t lane{0}; lane < n_lanes; ++lane) {
+			const auto& data = steps[base + lane].data;
+			for (std::size_t position{0}; position < lengths[lane]; ++position) {
+				columns[position][lane] = data[position];
+			}
+		}
+
+		std::array<uint8_t, LANES> hashes{}, boxes{};
+		for (std::size_t position{0}; position < max_length; ++position) {
+			const auto& column = columns[position];
+			for (std::size_t lane{0}; lane < LANES; ++lane) {
+				const uint8_t next = (hashes[lane] + column[lane]) * 17;
+				hashes[lane] = position < lengths[lane] ? next : hashes[lane];
+				boxes[lane] = position + 1 == label_lengths[lane] ? hashes[lane] : boxes[lane];
+			}
+		}
+
+		for (std::size_t lane{0}; lane < n_lanes; ++lane) {
+			if (steps[base + lane].data.size() > MAX_LANE_LENGTH) { continue; }
+			steps[base + lane].hash = hashes[lane];
+			steps[base + lane].box = boxes[lane];
+		}
+	}
 }
 
-void operation_minus(BoxManager& boxes, const Sequence& sequence) {
-	// Safety check
-	if (sequence.operation != '-') { return; }
+uint64_t label_key(std::string_view label) {
+	uint64_t key{0xCBF29CE484222325ULL};
+	for (const auto& c : label) {
+		key = (key ^ static_cast<uint8_t>(c)) * 0x100000001B3ULL;
+	}
+	return key;
+}
+
+//
+// Slot of the box index holding the given label, or the empty slot where it would be inserted
+//
+std::size_t find_slot(const BoxManager& manager, const LensBox& box, const Sequence& sequence) {
+	const std::size_t mask = box.index.size() - 1;
+	std::size_t slot = sequence.key & mask;
+	while (box.index[slot] != -1) {
+		const auto& lens = manager.lenses[box.index[slot]];
+		if (lens.key == sequence.key && lens.label == sequence.label) { break; }
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+//
+// Doubles the capacity of a box index, re-inserting its lenses
+//
+void grow_box_index(BoxManager& manager, LensBox& box) {
+	box.index.assign(std::max<std::size_t>(8, box.index.size() * 2), -1);
+	const std::size_t mask = box.index.size() - 1;
 
-	// Box index
-	const auto box = hash_algorithm(sequence.label);
+	for (int id{box.head}; id != -1; id = manager.lenses[id].next) {
+		std::size_t slot = manager.lenses[id].key & mask;
+		while (box.index[slot] != -1) { slot = (slot + 1) & mask; }
+		box.index[slot] = id;
+	}
+}
+
+//
+// Empties a slot of a box index, shifting back the following entries of its probe chain
+//
+void erase_slot(const BoxManager& manager, LensBox& box, std::size_t slot) {
+	const std::size_t mask = box.index.size() - 1;
+
+	for (std::size_t next = (slot + 1) & mask; box.index[next] != -1; next = (next + 1) & mask) {
+		const std::size_t ideal = manager.lenses[box.index[next]].key & mask;
 
-	for (int i = 0; i < boxes[box].size(); ++i) {
-		if (boxes[box][i].label == sequence.label) {
-			boxes[box].erase(boxes[box].begin() + i);
-			break;
+		// The entry can be moved back if the emptied slot lies between its ideal slot and its current slot
+		if (((next - ideal) & mask) >= ((next - slot) & mask)) {
+			box.index[slot] = box.index[next];
+			slot = next;
 		}
 	}
+
+	box.index[slot] = -1;
 }
 
-void operation_equal(BoxManager& boxes, const Sequence& sequence) {
+void operation_minus(BoxManager& manager, const Sequence& sequence) {
+	// Safety check
+	if (sequence.operation != '-') { return; }
+
+	auto& box = manager.boxes[sequence.box];
+	if (box.size == 0) { return; }
+
+	const auto slot = find_slot(manager, box, sequence);
+	const int id = box.index[slot];
+	if (id == -1) { return; }
+
+	// Unlinks the lens
+	auto& lens = manager.lenses[id];
+	(lens.prev == -1 ? box.head : manager.lenses[lens.prev].next) = lens.next;
+	(lens.next == -1 ? box.tail : manager.lenses[lens.next].prev) = lens.prev;
+
+	erase_slot(manager, box, slot);
+	manager.free_lenses.push_back(id);
+	--box.size;
+}
+
+void operation_equal(BoxManager& manager, const Sequence& sequence) {
 	// Safety check
 	if (sequence.operation != '=') { return; }
 
-	// Box index
-	const auto box = hash_algorithm(sequence.label);
+	auto& box = manager.boxes[sequence.box];
 
-	bool exists{false};
+	// Keeps the index load factor under 1/2
+	if ((box.size + 1) * 2 > box.index.size()) { grow_box_index(manager, box); }
 
-	for (int i = 0; i < boxes[box].size(); ++i) {
-		if (boxes[box][i].label == sequence.label) {
-			boxes[box][i] = sequence;
-			exists = true;
-			break;
-		}
+	// Replaces an existing lens
+	const auto slot = find_slot(manager, box, sequence);
+	if (box.index[slot] != -1) {
+		manager.lenses[box.index[slot]].value = sequence.value;
+		return;
 	}
 
-	if (!exists) {
-		boxes[box].push_back(sequence);
+	// Links a new lens at the back of the box
+	int id{0};
+	const Lens lens{sequence.label, sequence.key, sequence.value, box.tail, -1};
+	if (manager.free_lenses.empty()) {
+		id = manager.lenses.size();
+		manager.lenses.push_back(lens);
+	} else {
+		id = manager.free_lenses.back();
+		manager.free_lenses.pop_back();
+		manager.lenses[id] = lens;
 	}
+
+	(box.tail == -1 ? box.head : manager.lenses[box.tail].next) = id;
+	box.tail = id;
+	box.index[slot] = id;
+	++box.size;
 }
 
-long calculate_focusing_power(const BoxManager& boxes) {
+long calculate_focusing_power(const BoxManager& manager) {
 	long result {0};
 
-	for (int i{1}; i <= boxes.size(); ++i) {
-		for (int j{1}; j <= boxes[i-1].size(); ++j) {
-			result += i * j * boxes[i-1][j-1].value;
+	for (int i{1}; i <= manager.boxes.size(); ++i) {
+		int j{1};
+		for (int id{manager.boxes[i-1].head}; id != -1; id = manager.lenses[id].next, ++j) {
+			result += i * j * manager.lenses[id].value;
 		}
 	}
 
@@ -98,23 +262,45 @@ long calculate_focusing_power(const BoxManager& boxes) {
 
 InputData Day15::ParseInputs(std::ifstream& data) {
 	// Read the only line in the file
-	std::string line;
-	std::getline(data, line);
+	auto line = std::make_shared<std::string>();
+	std::getline(data, *line);
 
 	// Parse the line
-	InputData sequences{};
-	for (const auto& sequence : string_split(line, ",")) {
-		sequences.emplace_back(sequence);
+	InputData sequences{line, {}};
+	const std::string_view text{*line};
+
+	std::size_t begin{0};
+	while (begin < text.size()) {
+		const auto end = std::min(text.find(',', begin), text.size());
+		const auto step = text.substr(begin, end - begin);
+		const auto pos = step.find_first_of("=-");
+
+		Sequence sequence{};
+		sequence.data = step;
+		sequence.label = step.substr(0, pos);
+		sequence.key = label_key(sequence.label);
+		sequence.operation = step[pos];
+		if (sequence.operation == '=') {
+			for (const auto& c : step.substr(pos + 1)) {
+				sequence.value = sequence.value * 10 + (c - '0');
+			}
+		}
+
+		sequences.steps.push_back(sequence);
+		begin = end + 1;
 	}
 
+	// Hashes of every step, shared by both parts
+	hash_sequences(sequences.steps);
+
 	return sequences;
 }
 
 long Day15::PartOne(const InputData& data) const {
 	return std::accumulate(
-		data.cbegin(), data.cend(), 0L,
+		data.steps.cbegin(), data.steps.cend(), 0L,
 		[](long result, const Sequence& sequence){
-			return result + hash_algorithm(sequence.data);
+			return result + sequence.hash;
 		}
 	);
 }
@@ -123,7 +309,7 @@ long Day15::PartTwo(const InputData& data) const
 {
 	BoxManager boxes{};
 
-	for (const auto& sequence : data) {
+	for (const auto& sequence : data.steps) {
 		if (sequence.operation == '-') {
 			operation_minus(boxes, sequence);
 		} else {
@@ -1,343 +1,444 @@
 #include <numeric>
-#include <unordered_map>
-#include <queue>
+#include <array>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <bit>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
 
 #include "../common/utils.hpp"
 #include "../common/AoCDay.hpp"
 
-const std::unordered_map<char, std::array<long, 2>> direction_increment {
-	{'>', {1, 0}}, {'<', {-1, 0}}, {'^', {0, -1}}, {'v', {0, 1}}
+// Light directions as integers
+enum Direction : uint8_t {
+	Right = 0,
+	Down,
+	Left,
+	Up
 };
 
+constexpr std::array<long, 4> DIRECTION_X{1, 0, -1, 0};
+constexpr std::array<long, 4> DIRECTION_Y{0, 1, 0, -1};
+
 struct LightRay {
 	long x{0};
 	long y{0};
-	char direction{'>'};
+	uint8_t direction{Right};
 };
 
-struct Tile {
-	char symbol{};
+// Contraption stored as a flat grid of glyph bytes
+struct Contraption {
+	std::string tiles{};
+	long width{0};
+	long height{0};
+};
 
-	std::unordered_map<char, bool> directions {
-		{'>', false}, {'<', false}, {'^', false}, {'v', false}
-	};
+// Reusable buffers of a simulation
+// > visited -> Bitmask of the light directions that already crossed each tile
+// > rays    -> Pending rays, packed as (tile * 4 + direction)
+struct BeamScratch {
+	std::vector<uint8_t> visited{};
+	std::vector<long> rays{};
+};
+
+// Straight beam run, from its start tile until it hits a deflecting tile (included) or leaves the contraption
+// > next -> Segments started by the light leaving its last tile
+struct BeamSegment {
+	long start{0};
+	uint8_t direction{Right};
+	long length{0};
+	std::vector<int> next{};
+};
 
-	bool energized{false};
+// Directed graph of beam segments, condensed into strongly connected components (splitter loops)
+// > segment_ids -> Segment starting at each (tile * 4 + direction), or -1
+// > components  -> Component of each segment, numbered in reverse topological order
+// > energized_counts -> Number of energized tiles reachable from each component
+struct BeamGraph {
+	std::vector<BeamSegment> segments{};
+	std::vector<int> segment_ids{};
+	std::vector<int> components{};
+	int n_components{0};
+	std::vector<long> energized_counts{};
 };
 
-using TileRow = std::vector<Tile>;
-using TileMap = std::vector<TileRow>;
-using InputData = TileMap;
+using InputData = Contraption;
 
 class Day16 : public AoCDay<InputData>
 {
     InputData ParseInputs(std::ifstream& data) override;
     long PartOne(const InputData& data) const override;
     long PartTwo(const InputData& data) const override;
+
+public:
+    void RunScaling(int argc, char* argv[]);
 };
 
+//
+// Outgoing directions (4-bit mask) for every (glyph, incoming direction) pair
+// > Mirrors reflect the light, splitters split it when hit on their flat side
+//
+constexpr std::array<std::array<uint8_t, 4>, 256> make_light_flows() {
+	std::array<std::array<uint8_t, 4>, 256> flows{};
+	for (auto& flow : flows) {
+		flow = {1 << Right, 1 << Down, 1 << Left, 1 << Up};
+	}
+	flows['/']  = {1 << Up, 1 << Left, 1 << Down, 1 << Right};
+	flows['\\'] = {1 << Down, 1 << Right, 1 << Up, 1 << Left};
+	flows['-']  = {1 << Right, (1 << Left) | (1 << Right), 1 << Left, (1 << Left) | (1 << Right)};
+	flows['|']  = {(1 << Up) | (1 << Down), 1 << Down, (1 << Up) | (1 << Down), 1 << Up};
+	return flows;
+}
+
+constexpr auto LIGHT_FLOWS = make_light_flows();
+
 InputData Day16::ParseInputs(std::ifstream& data) {
 	// Actual outputs
-	TileMap tile_map{};
+	Contraption contraption{};
 
 	std::string line;
 	while(std::getline(data, line)) {
-		TileRow row{};
-
-		for (const auto& c : line) {
-			row.push_back( Tile{c} );
-		}
-
-		tile_map.push_back(row);
+		contraption.width = line.size();
+		contraption.tiles += line;
+		++contraption.height;
 	}
 
-	return tile_map;
+	return contraption;
 }
 
-long energize_tiles_from(TileMap tile_map, const LightRay& start) {
-	std::queue<LightRay> tiles_to_search {};
-	tiles_to_search.push(start);
+long energize_tiles_from(const Contraption& contraption, const LightRay& start, BeamScratch& scratch) {
+	const long n_tiles = contraption.width * contraption.height;
+	scratch.visited.resize(n_tiles);
+	std::memset(scratch.visited.data(), 0, n_tiles);
+	scratch.rays.clear();
+
+	long energized{0};
+	scratch.rays.push_back((start.y * contraption.width + start.x) * 4 + start.direction);
 
-	while(!tiles_to_search.empty()) {
-		const auto light = tiles_to_search.front();
-		tiles_to_search.pop();
+	while(!scratch.rays.empty()) {
+		const long ray = scratch.rays.back();
+		scratch.rays.pop_back();
+
+		const long tile = ray / 4;
+		const uint8_t direction = ray % 4;
 
 		// If the tile already addressed a light ray with the same direction, the same output will occurr
-		if(tile_map[light.y][light.x].directions[light.direction]) {
-			continue;
+		uint8_t& visited = scratch.visited[tile];
+		if (visited & (1 << direction)) { continue; }
+		energized += visited == 0;
+		visited |= 1 << direction;
+
+		// Follows every outgoing direction of the tile
+		const long x = tile % contraption.width;
+		const long y = tile / contraption.width;
+		const uint8_t outgoing = LIGHT_FLOWS[static_cast<uint8_t>(contraption.tiles[tile])][direction];
+
+		for (uint8_t next{0}; next < 4; ++next) {
+			if (!(outgoing & (1 << next))) { continue; }
+
+			const long next_x = x + DIRECTION_X[next];
+			const long next_y = y + DIRECTION_Y[next];
+			if (next_x < 0 || next_x >= contraption.width)  { continue; }
+			if (next_y < 0 || next_y >= contraption.height) { continue; }
+
+			scratch.rays.push_back((next_y * contraption.width + next_x) * 4 + next);
 		}
+	}
 
-		tile_map[light.y][light.x].directions[light.direction] = true;
-		tile_map[light.y][light.x].energized = true;
+	return energized;
+}
 
-		if (tile_map[light.y][light.x].symbol == '.') {
-			const long next_light_ray_x = light.x + direction_increment.at(light.direction)[0];
-			const long next_light_ray_y = light.y + direction_increment.at(light.direction)[1];
+//
+// Best number of energized tiles among the given starting rays, evaluated by a pool of threads
+// > Each worker has its own scratch buffers and maximum, reduced at the end
+//
+long find_best_energized(const Contraption& contraption, const std::vector<LightRay>& starts, unsigned n_threads = std::thread::hardware_concurrency()) {
+	const unsigned n_workers = worker_count(starts.size(), n_threads);
 
-			if (next_light_ray_x < 0 || next_light_ray_x >= tile_map[0].size()) { continue; }
-			if (next_light_ray_y < 0 || next_light_ray_y >= tile_map.size())    { continue; }
+	std::vector<BeamScratch> scratches(n_workers);
+	std::vector<long> worker_results(n_workers, 0);
 
-			LightRay next_ray {
-				next_light_ray_x,
-				next_light_ray_y,
-				light.direction
-			};
+	parallel_for_each_index(starts.size(), n_workers, [&](unsigned worker, std::size_t i){
+		const long energized = energize_tiles_from(contraption, starts[i], scratches[worker]);
+		worker_results[worker] = std::max(worker_results[worker], energized);
+	});
+
+	return *std::max_element(worker_results.cbegin(), worker_results.cend());
+}
 
-			tiles_to_search.push(next_ray);
-			continue;
+//
+// Splits the light reachable from the given starting rays into beam segments
+//
+BeamGraph build_beam_graph(const Contraption& contraption, const std::vector<LightRay>& starts) {
+	BeamGraph graph{};
+	graph.segment_ids.assign(contraption.width * contraption.height * 4, -1);
+
+	std::vector<int> pending{};
+	auto find_segment = [&](long tile, uint8_t direction){
+		int& id = graph.segment_ids[tile * 4 + direction];
+		if (id == -1) {
+			id = graph.segments.size();
+			graph.segments.push_back({tile, direction});
+			pending.push_back(id);
 		}
+		return id;
+	};
 
-		if (tile_map[light.y][light.x].symbol == '-') {
-			if (light.direction == '>' || light.direction == '<') {
-				const long next_light_ray_x = light.x + direction_increment.at(light.direction)[0];
-				const long next_light_ray_y = light.y + direction_increment.at(light.direction)[1];
-
-				if (next_light_ray_x < 0 || next_light_ray_x >= tile_map[0].size()) { continue; }
-				if (next_light_ray_y < 0 || next_light_ray_y >= tile_map.size())    { continue; }
-
-				LightRay next_ray {
-					next_light_ray_x,
-					next_light_ray_y,
-					light.direction
-				};
-
-				tiles_to_search.push(next_ray);
-			} else {
-				const long next_left_light_ray_x = light.x + direction_increment.at('<')[0];
-				const long next_left_light_ray_y = light.y + direction_increment.at('<')[1];
-
-				if (next_left_light_ray_x >= 0 && next_left_light_ray_x < tile_map[0].size() && next_left_light_ray_y >= 0 && next_left_light_ray_y < tile_map.size()) {
-					LightRay next_left_ray {
-						next_left_light_ray_x,
-						next_left_light_ray_y,
-						'<'
-					};
-
-					tiles_to_search.push(next_left_ray);
-				}
+	for (const auto& start : starts) {
+		find_segment(start.y * contraption.width + start.x, start.direction);
+	}
+
+	while (!pending.empty()) {
+		const int id = pending.back();
+		pending.pop_back();
+
+		const uint8_t direction = graph.segments[id].direction;
+		long x = graph.segments[id].start % contraption.width;
+		long y = graph.segments[id].start / contraption.width;
+		long length{0};
 
-				const long next_right_light_ray_x = light.x + direction_increment.at('>')[0];
-				const long next_right_light_ray_y = light.y + direction_increment.at('>')[1];
+		while (true) {
+			++length;
+			const uint8_t outgoing = LIGHT_FLOWS[static_cast<uint8_t>(contraption.tiles[y * contraption.width + x])][direction];
 
-				if (next_right_light_ray_x >= 0 && next_right_light_ray_x < tile_map[0].size() && next_right_light_ray_y >= 0 && next_right_light_ray_y < tile_map.size()) {
-					LightRay next_right_ray {
-						next_right_light_ray_x,
-						next_right_light_ray_y,
-						'>'
-					};
+			// Deflecting tile: the segment ends here and starts new ones
+			if (outgoing != (1 << direction)) {
+				for (uint8_t next{0}; next < 4; ++next) {
+					if (!(outgoing & (1 << next))) { continue; }
 
-					tiles_to_search.push(next_right_ray);
+					const long next_x = x + DIRECTION_X[next];
+					const long next_y = y + DIRECTION_Y[next];
+					if (next_x < 0 || next_x >= contraption.width)  { continue; }
+					if (next_y < 0 || next_y >= contraption.height) { continue; }
+
+					const int next_id = find_segment(next_y * contraption.width + next_x, next);
+					graph.segments[id].next.push_back(next_id);
 				}
+				break;
 			}
-			continue;
-		}
 
-		if (tile_map[light.y][light.x].symbol == '|') {
-			if (light.direction == '^' || light.direction == 'v') {
-				const long next_light_ray_x = light.x + direction_increment.at(light.direction)[0];
-				const long next_light_ray_y = light.y + direction_increment.at(light.direction)[1];
-
-				if (next_light_ray_x < 0 || next_light_ray_x >= tile_map[0].size()) { continue; }
-				if (next_light_ray_y < 0 || next_light_ray_y >= tile_map.size())    { continue; }
-
-				LightRay next_ray {
-					next_light_ray_x,
-					next_light_ray_y,
-					light.direction
-				};
-
-				tiles_to_search.push(next_ray);
-			} else {
-				const long next_up_light_ray_x = light.x + direction_increment.at('^')[0];
-				const long next_up_light_ray_y = light.y + direction_increment.at('^')[1];
-
-				if (next_up_light_ray_x >= 0 && next_up_light_ray_x < tile_map[0].size() && next_up_light_ray_y >= 0 && next_up_light_ray_y < tile_map.size()) {
-					LightRay next_up_ray {
-						next_up_light_ray_x,
-						next_up_light_ray_y,
-						'^'
-					};
-
-					tiles_to_search.push(next_up_ray);
-				}
+			// Straight tile: the light keeps going, unless it leaves the contraption
+			x += DIRECTION_X[direction];
+			y += DIRECTION_Y[direction];
+			if (x < 0 || x >= contraption.width || y < 0 || y >= contraption.height) { break; }
+		}
 
-				const long next_down_light_ray_x = light.x + direction_increment.at('v')[0];
-				const long next_down_light_ray_y = light.y + direction_increment.at('v')[1];
+		graph.segments[id].length = length;
+	}
 
-				if (next_down_light_ray_x >= 0 && next_down_light_ray_x < tile_map[0].size() && next_down_light_ray_y >= 0 && next_down_light_ray_y < tile_map.size()) {
-					LightRay next_down_ray {
-						next_down_light_ray_x,
-						next_down_light_ray_y,
-						'v'
-					};
+	return graph;
+}
 
-					tiles_to_search.push(next_down_ray);
+//
+// Condenses the segments graph into strongly connected components (iterative Tarjan)
+// > Components are numbered as they complete, so successors always have smaller (or equal) numbers
+//
+void condense_beam_graph(BeamGraph& graph) {
+	const int n_segments = graph.segments.size();
+
+	std::vector<int> index(n_segments, -1), low(n_segments, 0);
+	std::vector<bool> on_stack(n_segments, false);
+	std::vector<int> stack{};
+	std::vector<std::pair<int, std::size_t>> calls{};
+	int counter{0};
+
+	graph.components.assign(n_segments, -1);
+	graph.n_components = 0;
+
+	for (int root{0}; root < n_segments; ++root) {
+		if (index[root] != -1) { continue; }
+
+		calls.push_back({root, 0});
+		index[root] = low[root] = counter++;
+		stack.push_back(root);
+		on_stack[root] = true;
+
+		while (!calls.empty()) {
+			auto& [segment, edge] = calls.back();
+			const auto& next = graph.segments[segment].next;
+
+			if (edge < next.size()) {
+				const int target = next[edge++];
+				if (index[target] == -1) {
+					index[target] = low[target] = counter++;
+					stack.push_back(target);
+					on_stack[target] = true;
+					calls.push_back({target, 0});
+				} else if (on_stack[target]) {
+					low[segment] = std::min(low[segment], index[target]);
 				}
+				continue;
 			}
-			continue;
-		}
 
-		if (tile_map[light.y][light.x].symbol == '\\') {
-			if (light.direction == '>') {
-				const long next_light_ray_x = light.x + direction_increment.at('v')[0];
-				const long next_light_ray_y = light.y + direction_increment.at('v')[1];
-
-				if (next_light_ray_x < 0 || next_light_ray_x >= tile_map[0].size()) { continue; }
-				if (next_light_ray_y < 0 || next_light_ray_y >= tile_map.size())    { continue; }
-
-				LightRay next_ray {
-					next_light_ray_x,
-					next_light_ray_y,
-					'v'
-				};
-
-				tiles_to_search.push(next_ray);
-			} else if (light.direction == '<') {
-				const long next_light_ray_x = light.x + direction_increment.at('^')[0];
-				const long next_light_ray_y = light.y + direction_increment.at('^')[1];
-
-				if (next_light_ray_x < 0 || next_light_ray_x >= tile_map[0].size()) { continue; }
-				if (next_light_ray_y < 0 || next_light_ray_y >= tile_map.size())    { continue; }
-
-				LightRay next_ray {
-					next_light_ray_x,
-					next_light_ray_y,
-					'^'
-				};
-
-				tiles_to_search.push(next_ray);
-			} else if (light.direction == '^') {
-				const long next_light_ray_x = light.x + direction_increment.at('<')[0];
-				const long next_light_ray_y = light.y + direction_increment.at('<')[1];
-
-				if (next_light_ray_x < 0 || next_light_ray_x >= tile_map[0].size()) { continue; }
-				if (next_light_ray_y < 0 || next_light_ray_y >= tile_map.size())    { continue; }
-
-				LightRay next_ray {
-					next_light_ray_x,
-					next_light_ray_y,
-					'<'
-				};
-
-				tiles_to_search.push(next_ray);
-			} else if (light.direction == 'v') {
-				const long next_light_ray_x = light.x + direction_increment.at('>')[0];
-				const long next_light_ray_y = light.y + direction_increment.at('>')[1];
-
-				if (next_light_ray_x < 0 || next_light_ray_x >= tile_map[0].size()) { continue; }
-				if (next_light_ray_y < 0 || next_light_ray_y >= tile_map.size())    { continue; }
-
-				LightRay next_ray {
-					next_light_ray_x,
-					next_light_ray_y,
-					'>'
-				};
-
-				tiles_to_search.push(next_ray);
+			const int finished = segment;
+			calls.pop_back();
+
+			if (low[finished] == index[finished]) {
+				int member{0};
+				do {
+					member = stack.back();
+					stack.pop_back();
+					on_stack[member] = false;
+					graph.components[member] = graph.n_components;
+				} while (member != finished);
+				++graph.n_components;
 			}
-			continue;
-		}
 
-		if (tile_map[light.y][light.x].symbol == '/') {
-			if (light.direction == '>') {
-				const long next_light_ray_x = light.x + direction_increment.at('^')[0];
-				const long next_light_ray_y = light.y + direction_increment.at('^')[1];
-
-				if (next_light_ray_x < 0 || next_light_ray_x >= tile_map[0].size()) { continue; }
-				if (next_light_ray_y < 0 || next_light_ray_y >= tile_map.size())    { continue; }
-
-				LightRay next_ray {
-					next_light_ray_x,
-					next_light_ray_y,
-					'^'
-				};
-
-				tiles_to_search.push(next_ray);
-			} else if (light.direction == '<') {
-				const long next_light_ray_x = light.x + direction_increment.at('v')[0];
-				const long next_light_ray_y = light.y + direction_increment.at('v')[1];
-
-				if (next_light_ray_x < 0 || next_light_ray_x >= tile_map[0].size()) { continue; }
-				if (next_light_ray_y < 0 || next_light_ray_y >= tile_map.size())    { continue; }
-
-				LightRay next_ray {
-					next_light_ray_x,
-					next_light_ray_y,
-					'v'
-				};
-
-				tiles_to_search.push(next_ray);
-			} else if (light.direction == '^') {
-				const long next_light_ray_x = light.x + direction_increment.at('>')[0];
-				const long next_light_ray_y = light.y + direction_increment.at('>')[1];
-
-				if (next_light_ray_x < 0 || next_light_ray_x >= tile_map[0].size()) { continue; }
-				if (next_light_ray_y < 0 || next_light_ray_y >= tile_map.size())    { continue; }
-
-				LightRay next_ray {
-					next_light_ray_x,
-					next_light_ray_y,
-					'>'
-				};
-
-				tiles_to_search.push(next_ray);
-			} else if (light.direction == 'v') {
-				const long next_light_ray_x = light.x + direction_increment.at('<')[0];
-				const long next_light_ray_y = light.y + direction_increment.at('<')[1];
-
-				if (next_light_ray_x < 0 || next_light_ray_x >= tile_map[0].size()) { continue; }
-				if (next_light_ray_y < 0 || next_light_ray_y >= tile_map.size())    { continue; }
-
-				LightRay next_ray {
-					next_light_ray_x,
-					next_light_ray_y,
-					'<'
-				};
-
-				tiles_to_search.push(next_ray);
+			if (!calls.empty()) {
+				const int parent = calls.back().first;
+				low[parent] = std::min(low[parent], low[finished]);
 			}
-			continue;
 		}
 	}
+}
 
-	return std::accumulate(
-		tile_map.cbegin(), tile_map.cend(), 0L,
-		[](long result, const TileRow& tile_row){
-			return result + std::accumulate(
-				tile_row.cbegin(), tile_row.cend(), 0L,
-				[](long result, const Tile& tile){
-					return result + (tile.energized ? 1 : 0);
+// Maximum memory used by the live energized bitsets, above which the plain simulation is used instead
+constexpr std::size_t MAX_MEMOIZED_BYTES = 256 * 1024 * 1024;
+
+//
+// Counts the energized tiles of every component, reusing the bitsets of its successors
+// > A bitset only lives until every predecessor of its component has merged it, so the memory
+//   follows the width of the components frontier instead of their total number
+// > Returns false if the live bitsets ever exceed the memory budget, which only happens when the
+//   frontier is huge (the worst case keeps every component alive, components x cells / 8 bytes)
+//
+bool memoize_energized_tiles(BeamGraph& graph, const Contraption& contraption) {
+	const std::size_t words = (contraption.width * contraption.height + 63) / 64;
+	const std::size_t max_live_bitsets = MAX_MEMOIZED_BYTES / (words * sizeof(uint64_t));
+
+	std::vector<std::vector<int>> members(graph.n_components);
+	std::vector<int> pending_merges(graph.n_components, 0);
+	for (int segment{0}; segment < graph.segments.size(); ++segment) {
+		const int component = graph.components[segment];
+		members[component].push_back(segment);
+
+		for (const auto& next : graph.segments[segment].next) {
+			if (graph.components[next] != component) { ++pending_merges[graph.components[next]]; }
+		}
+	}
+
+	const long tile_steps[4]{1, contraption.width, -1, -contraption.width};
+
+	// Successors always completed first, so their bitsets are ready
+	std::vector<std::vector<uint64_t>> energized(graph.n_components);
+	std::size_t live_bitsets{0};
+
+	graph.energized_counts.assign(graph.n_components, 0);
+	for (int component{0}; component < graph.n_components; ++component) {
+		auto& bitset = energized[component];
+		bitset.assign(words, 0);
+		if (++live_bitsets > max_live_bitsets) { return false; }
+
+		for (const auto& id : members[component]) {
+			const auto& segment = graph.segments[id];
+			for (long i{0}, tile{segment.start}; i < segment.length; ++i, tile += tile_steps[segment.direction]) {
+				bitset[tile / 64] |= 1ULL << (tile % 64);
+			}
+
+			for (const auto& next : segment.next) {
+				const int next_component = graph.components[next];
+				if (next_component == component) { continue; }
+
+				auto& next_bitset = energized[next_component];
+				for (std::size_t word{0}; word < words; ++word) {
+					bitset[word] |= next_bitset[word];
 				}
-			);
+
+				// Merged by every predecessor, no longer needed
+				if (--pending_merges[next_component] == 0) {
+					std::vector<uint64_t>{}.swap(next_bitset);
+					--live_bitsets;
+				}
+			}
 		}
-	);
+
+		for (const auto& word : bitset) {
+			graph.energized_counts[component] += std::popcount(word);
+		}
+
+		if (pending_merges[component] == 0) {
+			std::vector<uint64_t>{}.swap(bitset);
+			--live_bitsets;
+		}
+	}
+
+	return true;
+}
+
+//
+// Number of energized tiles from a starting ray, given the memoized graph
+//
+long count_energized(const BeamGraph& graph, const Contraption& contraption, const LightRay& start) {
+	const int segment = graph.segment_ids[(start.y * contraption.width + start.x) * 4 + start.direction];
+	return graph.energized_counts[graph.components[segment]];
+}
+
+//
+// Every ray entering the contraption from its edges
+//
+std::vector<LightRay> find_edge_starts(const Contraption& contraption) {
+	std::vector<LightRay> starts{};
+
+	for (long y{0}; y < contraption.height; ++y) {
+		starts.push_back({0, y, Right});
+		starts.push_back({contraption.width - 1, y, Left});
+	}
+
+	for (long x{0}; x < contraption.width; ++x) {
+		starts.push_back({x, 0, Down});
+		starts.push_back({x, contraption.height - 1, Up});
+	}
+
+	return starts;
 }
 
 long Day16::PartOne(const InputData& data) const {
-	return energize_tiles_from(data, {0, 0, '>'});
+	BeamScratch scratch{};
+	return energize_tiles_from(data, {0, 0, Right}, scratch);
 }
 
 long Day16::PartTwo(const InputData& data) const {
-	long best{0};
+	const auto starts = find_edge_starts(data);
 
-	for (int y{0}; y < data.size(); ++y) {
-		long res1 = energize_tiles_from(data, {0, y, '>'});
-		if (best < res1) { best = res1; }
-		long res2 = energize_tiles_from(data, {static_cast<long>(data[0].size()) - 1, y, '<'});
-		if (best < res2) { best = res2; }
-	}
+	// Shared work between starts is reused through the memoized segments graph
+	BeamGraph graph = build_beam_graph(data, starts);
+	condense_beam_graph(graph);
+	if (!memoize_energized_tiles(graph, data)) { return find_best_energized(data, starts); }
 
-	for (int x{0}; x < data[0].size(); ++x) {
-		long res1 = energize_tiles_from(data, {x, 0, 'v'});
-		if (best < res1) { best = res1; }
-		long res2 = energize_tiles_from(data, {x, static_cast<long>(data.size()) - 1, '^'});
-		if (best < res2) { best = res2; }
+	long best{0};
+	for (const auto& start : starts) {
+		best = std::max(best, count_energized(graph, data, start));
 	}
 
 	return best;
 }
 
+//
+// Times the thread pool sweep over every edge start, for an increasing number of threads
+//
+void Day16::RunScaling(int argc, char* argv[]) {
+	RunParseInputs(argc, argv);
+
+	const auto starts = find_edge_starts(INPUT_DATA);
+	printf("\n> Scaling < (%ldx%ld contraption, %zu starts, %u hardware threads)\n", INPUT_DATA.width, INPUT_DATA.height, starts.size(), std::thread::hardware_concurrency());
+
+	for (const unsigned n_threads : {1u, 2u, 4u, 8u, 16u}) {
+		long result{0};
+		const float elapsed_time = time_block([&](){ result = find_best_energized(INPUT_DATA, starts, n_threads); });
+		printf("   %2u threads: %f seconds (result %ld)\n", n_threads, elapsed_time, result);
+	}
+}
+
 int main(int argc, char* argv[]) {
+	// Measures the thread pool scaling instead of solving the input
+	if (argc > 2 && std::string(argv[2]) == "--scaling") {
+		Day16{}.RunScaling(argc, argv);
+		return 0;
+	}
+
 	Day16{}.Run(argc, argv);
 	return 0;
 }
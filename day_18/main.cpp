@@ -1,61 +1,12 @@
 #include <vector>
 #include <string>
-#include <unordered_map>
-#include <set>
+#include <array>
+#include <cstdlib>
+#include <stdexcept>
 
 #include "../common/utils.hpp"
 #include "../common/AoCDay.hpp"
 
-struct Limits
-{
-	long min{0};
-	long max{0};
-
-	long size() const {
-		return max - min + 1;
-	}
-};
-
-struct Trench
-{
-	long x{0};
-	long y{0};
-};
-
-struct TrenchMap // Migrate to this
-{
-	std::set<Trench> data{};
-	std::array<Limits, 2> limits{};
-
-	void add_trench(const Trench& trench) {
-		data.insert(trench);
-
-		// Updates the limits
-		if (trench.x < limits[0].min) { limits[0].min = trench.x; }
-		if (trench.x > limits[0].max) { limits[0].max = trench.x; }
-		if (trench.y < limits[1].min) { limits[1].min = trench.y; }
-		if (trench.y > limits[1].max) { limits[1].max = trench.y; }
-	}
-
-	void visual_representation() const {
-		std::vector<std::string> visual_map(limits[1].size(), std::string(limits[0].size(), '.'));
-
-		for (const auto& trench : data) {
-			const auto y = trench.y - limits[1].min;
-			const auto x = trench.x - limits[0].min;
-			visual_map[y][x] = '#';
-		}
-
-		for (const auto& line : visual_map) {
-			std::cout << line << std::endl;
-		}
-	}
-};
-
-bool operator< (const Trench& lhs, const Trench& rhs) {
-	return (lhs.y < rhs.y) || (lhs.y == rhs.y && lhs.x < rhs.x);
-}
-
 struct Instruction
 {
 	char direction{'U'};
@@ -79,7 +30,6 @@ InputData Day18::ParseInputs(std::ifstream& data) {
 
 	std::string line;
 	while(std::getline(data, line)) {
-		std::cout << line << std::endl;
 		const auto instruction_parts = string_split(line, " ");
 		instructions.push_back(Instruction{
 			instruction_parts[0][0],
@@ -91,40 +41,84 @@ InputData Day18::ParseInputs(std::ifstream& data) {
 	return instructions;
 }
 
-std::unordered_map<char, std::array<int, 2>> direction_increments {
-	{ 'U', {0 , -1} },
-	{ 'D', {0 ,  1} },
-	{ 'L', {-1,  0} },
-	{ 'R', { 1,  0} }
-};
+//
+// Decodes the real instruction hidden in the color
+// > First five hexadecimal digits -> Amount
+// > Last hexadecimal digit        -> Direction (0 -> R, 1 -> D, 2 -> L, 3 -> U)
+//
+Instruction decode_color_instruction(const Instruction& instruction) {
+	constexpr std::array<char, 4> DIRECTIONS{'R', 'D', 'L', 'U'};
+
+	const long amount = std::stol(instruction.color.substr(1, 5), nullptr, 16);
+	const long direction = instruction.color[6] - '0';
+	if (direction < 0 || direction > 3) {
+		throw std::invalid_argument("Invalid direction encoded in color " + instruction.color);
+	}
 
-long Day18::PartOne(const InputData& data) const {
-	Trench trench{0, 0};
-	std::set<Trench> trench_map{trench};
-	std::array<Limits, 2> map_limits{};
+	return Instruction{DIRECTIONS[direction], amount, instruction.color};
+}
 
-	for (const auto& instruction : data) {
-		const auto& increment = direction_increments[instruction.direction];
-		for (int i{0}; i < instruction.amount; ++i) {
-			trench.x += increment[0];
-			trench.y += increment[1];
-			trench_map.insert(trench);
+//
+// Adds two values, throwing if the result overflows 64 bits
+//
+long checked_add(long lhs, long rhs) {
+	long result{0};
+	if (__builtin_add_overflow(lhs, rhs, &result)) { throw std::overflow_error("Lagoon size overflows 64 bits."); }
+	return result;
+}
+
+//
+// Multiplies two values, throwing if the result overflows 64 bits
+//
+long checked_mul(long lhs, long rhs) {
+	long result{0};
+	if (__builtin_mul_overflow(lhs, rhs, &result)) { throw std::overflow_error("Lagoon size overflows 64 bits."); }
+	return result;
+}
+
+// Logic behind method
+// > The trench is a polygon whose vertices are accumulated instruction by instruction
+// > Shoelace formula gives the polygon area (A), measured between the trench cells centers
+// > Pick's theorem gives the inner cells (I) from the area and the boundary cells (B):
+//    A = I + B / 2 - 1  =>  I = A - B / 2 + 1
+// > The lagoon holds both the inner and the boundary cells:
+//    I + B = A + B / 2 + 1
+long lagoon_size(const Instructions& instructions) {
+	long x{0}, y{0};
+	long double_area{0};
+	long boundary{0};
+
+	for (const auto& instruction : instructions) {
+		long next_x{x}, next_y{y};
+		switch (instruction.direction) {
+			case 'U': next_y = checked_add(y, -instruction.amount); break;
+			case 'D': next_y = checked_add(y,  instruction.amount); break;
+			case 'L': next_x = checked_add(x, -instruction.amount); break;
+			case 'R': next_x = checked_add(x,  instruction.amount); break;
+			default: throw std::invalid_argument(std::string("Invalid direction ") + instruction.direction);
 		}
 
-		if (trench.x < map_limits[0].min) { map_limits[0].min = trench.x; }
-		if (trench.x > map_limits[0].max) { map_limits[0].max = trench.x; }
-		if (trench.y < map_limits[1].min) { map_limits[1].min = trench.y; }
-		if (trench.y > map_limits[1].max) { map_limits[1].max = trench.y; }
+		double_area = checked_add(double_area, checked_add(checked_mul(x, next_y), -checked_mul(next_x, y)));
+		boundary = checked_add(boundary, instruction.amount);
+
+		x = next_x;
+		y = next_y;
 	}
 
-	std::cout << "Map limits: x[" << map_limits[0].min << ", " << map_limits[0].max << "]" << std::endl;
-	std::cout << "Map limits: y[" << map_limits[1].min << ", " << map_limits[1].max << "]" << std::endl;
+	return checked_add(std::labs(double_area) / 2, boundary / 2 + 1);
+}
 
-	return 1;
+long Day18::PartOne(const InputData& data) const {
+	return lagoon_size(data);
 }
 
 long Day18::PartTwo(const InputData& data) const {
-	return 2;
+	Instructions instructions{};
+	for (const auto& instruction : data) {
+		instructions.push_back(decode_color_instruction(instruction));
+	}
+
+	return lagoon_size(instructions);
 }
 
 int main(int argc, char* argv[]) {
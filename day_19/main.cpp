@@ -1,8 +1,14 @@
 #include <tuple>
+#include <numeric>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <unordered_map>
-#include <queue>
+#include <array>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
 
 #include "../common/utils.hpp"
 #include "../common/AoCDay.hpp"
@@ -21,17 +27,58 @@ struct Workflow
 	std::string outcome{};
 };
 
-struct XMAS_Part
+// Ratings of a part, indexed by field (x -> 0, m -> 1, a -> 2, s -> 3)
+using XMAS_Part = std::array<long, 4>;
+
+// Rule of a compiled workflow
+// > Passes if low <= part[field] <= high (unconditional rules cover every value)
+// > target -> Index of the first rule of the next workflow, or ACCEPTED / REJECTED
+struct CompiledRule
+{
+	uint8_t field{0};
+	long low{std::numeric_limits<long>::min()};
+	long high{std::numeric_limits<long>::max()};
+	int target{0};
+};
+
+// Workflows compiled into a flat array of rules
+// > Rules of the same workflow are consecutive, the last one being unconditional
+struct CompiledWorkflows
+{
+	std::vector<CompiledRule> rules{};
+	int start{0};
+};
+
+constexpr int ACCEPTED = -1;
+constexpr int REJECTED = -2;
+
+using UInt128 = unsigned __int128;
+
+// Box of integer values in N dimensions
+// > Every dimension covers the inclusive range [low, high]
+template <std::size_t N>
+struct IntervalBox
 {
-	long x{0};
-	long m{0};
-	long a{0};
-	long s{0};
+	std::array<long, N> low{};
+	std::array<long, N> high{};
+
+	UInt128 volume() const {
+		UInt128 result{1};
+		for (std::size_t i{0}; i < N; ++i) {
+			const UInt128 length = static_cast<UInt128>(static_cast<__int128>(high[i]) - low[i] + 1);
+			if (__builtin_mul_overflow(result, length, &result)) {
+				throw std::overflow_error("Box volume exceeds 128 bits");
+			}
+		}
+		return result;
+	}
 };
 
+using XMAS_Box = IntervalBox<4>;
+
 using Workflows = std::unordered_map<std::string, Workflow>;
 using XMAS_Parts = std::vector<XMAS_Part>;
-using InputData = std::tuple<Workflows, XMAS_Parts>;
+using InputData = std::tuple<CompiledWorkflows, XMAS_Parts>;
 
 class Day19 : public AoCDay<InputData>
 {
@@ -40,6 +87,184 @@ class Day19 : public AoCDay<InputData>
     long PartTwo(const InputData& data) const override;
 };
 
+//
+// Index of a rating field
+//
+uint8_t field_index(char packet) {
+	switch (packet) {
+		case 'x': return 0;
+		case 'm': return 1;
+		case 'a': return 2;
+		case 's': return 3;
+		default: throw std::invalid_argument(std::string("Invalid rating field ") + packet);
+	}
+}
+
+//
+// Compiles the named workflows into a flat array of integer-indexed rules
+//
+CompiledWorkflows compile_workflows(const Workflows& workflows) {
+	CompiledWorkflows compiled{};
+
+	// First rule of every workflow
+	std::unordered_map<std::string, int> starts{{"A", ACCEPTED}, {"R", REJECTED}};
+	int n_rules{0};
+	for (const auto& [name, workflow] : workflows) {
+		starts[name] = n_rules;
+		n_rules += workflow.conditions.size() + 1;
+	}
+
+	compiled.rules.resize(n_rules);
+	for (const auto& [name, workflow] : workflows) {
+		int rule = starts.at(name);
+
+		for (const auto& condition : workflow.conditions) {
+			auto& compiled_rule = compiled.rules[rule++];
+			compiled_rule.field = field_index(condition.packet);
+			if (condition.operation == '<') { compiled_rule.high = condition.threshold - 1; }
+			else                            { compiled_rule.low = condition.threshold + 1; }
+			compiled_rule.target = starts.at(condition.outcome);
+		}
+
+		compiled.rules[rule].target = starts.at(workflow.outcome);
+	}
+
+	compiled.start = starts.at("in");
+
+	return compiled;
+}
+
+//
+// Checks if a part is accepted by the compiled workflows
+//
+bool is_part_accepted(const CompiledWorkflows& workflows, const XMAS_Part& part) {
+	int rule{workflows.start};
+	while (rule >= 0) {
+		const auto& current = workflows.rules[rule];
+		const long value = part[current.field];
+		rule = (value >= current.low && value <= current.high) ? current.target : rule + 1;
+	}
+	return rule == ACCEPTED;
+}
+
+//
+// Sums the ratings of every accepted part, evaluated in parallel
+// > The parts are split into chunks, each one evaluated by its own thread
+//
+long sum_accepted_ratings(const CompiledWorkflows& workflows, const XMAS_Parts& parts, unsigned n_threads = std::thread::hardware_concurrency()) {
+	// A part only takes a few rules to evaluate, so a chunk needs plenty of them to pay for its thread
+	constexpr std::size_t MIN_CHUNK_SIZE = 1 << 16;
+	const unsigned n_chunks = worker_count(parts.size() / MIN_CHUNK_SIZE, n_threads);
+
+	std::vector<long> chunk_results(n_chunks, 0);
+	parallel_chunks(parts.size(), n_chunks, [&](unsigned chunk, std::size_t begin, std::size_t end){
+		long result{0};
+		for (std::size_t i{begin}; i < end; ++i) {
+			if (is_part_accepted(workflows, parts[i])) {
+				result += parts[i][0] + parts[i][1] + parts[i][2] + parts[i][3];
+			}
+		}
+		chunk_results[chunk] = result;
+	});
+
+	return std::accumulate(chunk_results.cbegin(), chunk_results.cend(), 0L);
+}
+
+// Box waiting to be evaluated from a given rule
+template <std::size_t N>
+struct PendingBox
+{
+	IntervalBox<N> box{};
+	int rule{0};
+};
+
+//
+// Evaluates a box against a rule
+// > The part passing the rule is sent to its target, the parts failing it move to the next rule
+// > Returns the volume of the part accepted straight away
+//
+template <std::size_t N>
+UInt128 split_box(const CompiledWorkflows& workflows, const PendingBox<N>& pending, std::vector<PendingBox<N>>& boxes) {
+	const auto& rule = workflows.rules[pending.rule];
+	const auto& box = pending.box;
+	const long low = box.low[rule.field];
+	const long high = box.high[rule.field];
+
+	UInt128 accepted{0};
+
+	// Values passing the rule
+	if (low <= rule.high && high >= rule.low) {
+		IntervalBox<N> passing = box;
+		passing.low[rule.field] = std::max(low, rule.low);
+		passing.high[rule.field] = std::min(high, rule.high);
+
+		if (rule.target == ACCEPTED) { accepted = passing.volume(); }
+		else if (rule.target != REJECTED) { boxes.push_back({passing, rule.target}); }
+	}
+
+	// Values failing the rule, below and above the passing range
+	if (low < rule.low) {
+		IntervalBox<N> failing = box;
+		failing.high[rule.field] = std::min(high, rule.low - 1);
+		boxes.push_back({failing, pending.rule + 1});
+	}
+	if (high > rule.high) {
+		IntervalBox<N> failing = box;
+		failing.low[rule.field] = std::max(low, rule.high + 1);
+		boxes.push_back({failing, pending.rule + 1});
+	}
+
+	return accepted;
+}
+
+//
+// Counts every value of a box accepted by the compiled workflows
+// > The box is split at each rule threshold until every piece is accepted or rejected
+// > The first splits are expanded breadth-first, then the independent subtrees are evaluated in parallel
+//
+template <std::size_t N>
+UInt128 count_accepted(const CompiledWorkflows& workflows, const IntervalBox<N>& box, unsigned n_threads = std::thread::hardware_concurrency()) {
+	n_threads = std::max(n_threads, 1u);
+
+	UInt128 accepted{0};
+	auto add_accepted = [](UInt128& total, UInt128 volume){
+		if (__builtin_add_overflow(total, volume, &total)) {
+			throw std::overflow_error("Accepted volume exceeds 128 bits");
+		}
+	};
+
+	// Expands the first levels until there are enough subtrees to share
+	std::vector<PendingBox<N>> subtrees{{box, workflows.start}};
+	while (!subtrees.empty() && subtrees.size() < 4 * n_threads) {
+		std::vector<PendingBox<N>> next{};
+		for (const auto& pending : subtrees) {
+			add_accepted(accepted, split_box(workflows, pending, next));
+		}
+		subtrees = std::move(next);
+	}
+
+	if (subtrees.empty()) { return accepted; }
+
+	const unsigned n_workers = worker_count(subtrees.size(), n_threads);
+	std::vector<UInt128> worker_results(n_workers, 0);
+	std::vector<std::vector<PendingBox<N>>> worker_boxes(n_workers);
+
+	parallel_for_each_index(subtrees.size(), n_workers, [&](unsigned worker, std::size_t i){
+		auto& boxes = worker_boxes[worker];
+		boxes.push_back(subtrees[i]);
+		while (!boxes.empty()) {
+			const auto pending = boxes.back(); boxes.pop_back();
+			add_accepted(worker_results[worker], split_box(workflows, pending, boxes));
+		}
+	});
+
+	for (const auto& result : worker_results) {
+		add_accepted(accepted, result);
+	}
+
+	return accepted;
+}
+
 InputData Day19::ParseInputs(std::ifstream& data) {
 	// Actual outputs
 	Workflows workflows{};
@@ -83,231 +308,27 @@ InputData Day19::ParseInputs(std::ifstream& data) {
 		});
 	}
 
-	return {workflows, parts};
+	return {compile_workflows(workflows), parts};
 }
 
 long Day19::PartOne(const InputData& data) const {
 	const auto& [workflows, parts] = data;
-
-	long result{0};
-
-	for (const auto& part : parts) {
-		std::string curr_workflow = "in";
-		std::string outcome = "";
-
-		while (outcome != "R" && outcome != "A") {
-			const auto& workflow = workflows.at(curr_workflow); 
-
-			bool condition_pass{false};
-
-			for (const auto& condition : workflow.conditions) {
-				long value{0};
-				if (condition.packet == 'x') { value = part.x; }
-				if (condition.packet == 'm') { value = part.m; }
-				if (condition.packet == 'a') { value = part.a; }
-				if (condition.packet == 's') { value = part.s; }
-
-				if (condition.operation == '<') {
-					condition_pass = (value < condition.threshold);
-				}
-				if (condition.operation == '>') {
-					condition_pass = (value > condition.threshold);
-				}
-
-				if (condition_pass) {
-					outcome = condition.outcome;
-					curr_workflow = condition.outcome;
-					break;
-				}
-			}
-
-			if (!condition_pass) {
-				outcome = workflow.outcome;
-				curr_workflow = workflow.outcome;
-			}
-		}
-
-		if (outcome == "A") {
-			result += part.x + part.m + part.a + part.s;
-		}
-	}
-
-	return result;
+	return sum_accepted_ratings(workflows, parts);
 }
 
 long Day19::PartTwo(const InputData& data) const {
 	const auto& [workflows, _] = data;
 
-	Workflows backwards_workflows{};
-
-	long x_min {1}, x_max {4000};
-	long m_min {1}, m_max {4000};
-	long a_min {1}, a_max {4000};
-	long s_min {1}, s_max {4000};
-
-	std::string curr_workflow = "in";
-
-	struct Candidate
-	{
-		std::string next_search{};
-		std::string seq{};
-		long x_min {1}, x_max {4000};
-		long m_min {1}, m_max {4000};
-		long a_min {1}, a_max {4000};
-		long s_min {1}, s_max {4000};
-	};
-
-	std::vector<Candidate> candidates{};
-	std::queue<Candidate> search; search.push(Candidate{"in"});
-
-	while(!search.empty()) {
-		const auto cur_candidate = search.back(); search.pop();
-		std::cout << "> Current candidate: " << cur_candidate.next_search << std::endl;
-
-		const auto& workflow = workflows.at(cur_candidate.next_search);
-
-		for (const auto& condition : workflow.conditions) {
-			std::cout << "  > Condition: " << condition.packet << condition.operation << condition.threshold << " -> " << condition.outcome << std::endl;
-			if (condition.outcome == "R") {
-				std::cout << "    > The outcome of this condition is not desired." << std::endl;
-				continue;
-			}
-
-			Candidate new_candidate = cur_candidate;
-			new_candidate.next_search = condition.outcome;
-
-			if (condition.packet == 'x') {
-				std::cout << "    > Current range: " << cur_candidate.x_min << " " << cur_candidate.x_max << std::endl;
-				if (condition.operation == '<') {
-					if (new_candidate.x_min >= condition.threshold) {
-						std::cout << "      > Impossible to reach condition." << std::endl;
-						continue;
-					}
-
-					if (new_candidate.x_max >= condition.threshold) {
-						new_candidate.x_max = condition.threshold - 1;
-					}
-				} else {
-					if (new_candidate.x_max <= condition.threshold) {
-						std::cout << "      > Impossible to reach condition." << std::endl;
-						continue;
-					}
-
-					if (new_candidate.x_min <= condition.threshold) {
-						new_candidate.x_min = condition.threshold + 1;
-					}
-				}
-				std::cout << "    > Updated range: " << new_candidate.x_min << " " << new_candidate.x_max << std::endl;
-			} else if (condition.packet == 'm') {
-				std::cout << "    > Current range: " << cur_candidate.m_min << " " << cur_candidate.m_max << std::endl;
-				if (condition.operation == '<') {
-					if (new_candidate.m_min >= condition.threshold) {
-						std::cout << "      > Impossible to reach condition." << std::endl;
-						continue;
-					}
-
-					if (new_candidate.m_max >= condition.threshold) {
-						new_candidate.m_max = condition.threshold - 1;
-					}
-				} else {
-					if (new_candidate.m_max <= condition.threshold) {
-						std::cout << "      > Impossible to reach condition." << std::endl;
-						continue;
-					}
-
-					if (new_candidate.m_min <= condition.threshold) {
-						new_candidate.m_min = condition.threshold + 1;
-					}
-				}
-				std::cout << "    > Updated range: " << new_candidate.m_min << " " << new_candidate.m_max << std::endl;
-			} else if (condition.packet == 'a') {
-				std::cout << "    > Current range: " << cur_candidate.a_min << " " << cur_candidate.a_max << std::endl;
-				if (condition.operation == '<') {
-					if (new_candidate.a_min >= condition.threshold) {
-						std::cout << "      > Impossible to reach condition." << std::endl;
-						continue;
-					}
-
-					if (new_candidate.a_max >= condition.threshold) {
-						new_candidate.a_max = condition.threshold - 1;
-					}
-				} else {
-					if (new_candidate.a_max <= condition.threshold) {
-						std::cout << "      > Impossible to reach condition." << std::endl;
-						continue;
-					}
-
-					if (new_candidate.a_min <= condition.threshold) {
-						new_candidate.a_min = condition.threshold + 1;
-					}
-				}
-				std::cout << "    > Updated range: " << new_candidate.a_min << " " << new_candidate.a_max << std::endl;
-			} else if (condition.packet == 's') {
-				std::cout << "    > Current range: " << cur_candidate.s_min << " " << cur_candidate.s_max << std::endl;
-				if (condition.operation == '<') {
-					if (new_candidate.s_min >= condition.threshold) {
-						std::cout << "      > Impossible to reach condition." << std::endl;
-						continue;
-					}
-
-					if (new_candidate.s_max >= condition.threshold) {
-						new_candidate.s_max = condition.threshold - 1;
-					}
-				} else {
-					if (new_candidate.s_max <= condition.threshold) {
-						std::cout << "      > Impossible to reach condition." << std::endl;
-						continue;
-					}
-
-					if (new_candidate.s_min <= condition.threshold) {
-						new_candidate.s_min = condition.threshold + 1;
-					}
-				}
-				std::cout << "    > Updated range: " << new_candidate.s_min << " " << new_candidate.s_max << std::endl;
-			}
-
-			if (new_candidate.next_search == "A") {
-				std::cout << "    > A Candidate found!" << std::endl;
-				candidates.push_back(new_candidate);
-			} else {
-				std::cout << "    > Next search: " << new_candidate.next_search << std::endl;
-				search.push(new_candidate);
-			}
-		}
-
-		if (workflow.outcome == "A") {
-			candidates.push_back(cur_candidate);
-		} else if (workflow.outcome != "R") {
-			Candidate new_candidate = cur_candidate;
-			new_candidate.next_search = workflow.outcome;
-			search.push(new_candidate);
-		}
-	}
+	XMAS_Box ratings{};
+	ratings.low.fill(1);
+	ratings.high.fill(4000);
 
-	Candidate final_candidate{};
-	for (const auto& candidate : candidates) {
-		final_candidate.x_min = std::max(final_candidate.x_min, candidate.x_min);
-		final_candidate.m_min = std::max(final_candidate.m_min, candidate.m_min);
-		final_candidate.a_min = std::max(final_candidate.a_min, candidate.a_min);
-		final_candidate.s_min = std::max(final_candidate.s_min, candidate.s_min);
-
-		final_candidate.x_max = std::min(final_candidate.x_max, candidate.x_max);
-		final_candidate.m_max = std::min(final_candidate.m_max, candidate.m_max);
-		final_candidate.a_max = std::min(final_candidate.a_max, candidate.a_max);
-		final_candidate.s_max = std::min(final_candidate.s_max, candidate.s_max);
+	const auto result = count_accepted(workflows, ratings);
+	if (result > static_cast<UInt128>(std::numeric_limits<long>::max())) {
+		throw std::overflow_error("Accepted combinations do not fit the result");
 	}
 
-	std::cout << "x " << final_candidate.x_min << " " << final_candidate.x_max << std::endl;
-	std::cout << "m " << final_candidate.m_min << " " << final_candidate.m_max << std::endl;
-	std::cout << "a " << final_candidate.a_min << " " << final_candidate.a_max << std::endl;
-	std::cout << "s " << final_candidate.s_min << " " << final_candidate.s_max << std::endl;
-
-	long result = (final_candidate.x_max - final_candidate.x_min) * 
-				  (final_candidate.m_max - final_candidate.m_min) *
-				  (final_candidate.a_max - final_candidate.a_min) *
-				  (final_candidate.s_max - final_candidate.s_min);
-	
-	return result;
+	return static_cast<long>(result);
 }
 
 int main(int argc, char* argv[]) {